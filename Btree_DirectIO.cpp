@@ -0,0 +1,117 @@
+/**
+ * this file has :
+ * 1- the direct I/O backend : the index file is opened with O_DIRECT, so
+ *    the kernel page cache never holds its nodes, and every node goes
+ *    through page-aligned buffers
+ * 2- the node cache of the direct mode : a fixed number of page-aligned
+ *    buffers with LRU eviction, so the memory used for nodes is exactly
+ *    capacity * directPageSize bytes
+ *
+ * direct files use the paged layout : page 0 holds the superblock and RRN r
+ * lives alone in page r (the row and its CRC first, zero padding after it).
+ * a page is checked once, when it is loaded from disk; cache hits are trusted.
+ * the mode is chosen when the file is opened (OpenIndex in BuildABtree.cpp);
+ * while it is open, all row and superblock I/O goes through this backend
+ **/
+
+#include <fcntl.h>
+#include <unistd.h>
+
+const int directPageSize = 4096;
+
+struct DirectIndex {
+    int fd = -1;
+    size_t capacity = 0;                  // pages the cache may hold
+    list<int> lru;                        // cached pages, most recently used first
+    struct CachedPage {
+        char* data;
+        list<int>::iterator position;
+    };
+    unordered_map<int, CachedPage> pages;
+    long long hits = 0, misses = 0, writes = 0;
+    bool (*verify)(int page, const char* data) = nullptr; // checks a page read from disk
+
+    bool active() const { return fd != -1; }
+};
+
+DirectIndex directIndex;
+
+/// Cache buffer for a page, evicting the least recently used one when full.
+/// The buffer is filled from disk only when `load` is set.
+char* directPage(int page, bool load) {
+    auto it = directIndex.pages.find(page);
+    if (it != directIndex.pages.end()) {
+        directIndex.hits++;
+        directIndex.lru.splice(directIndex.lru.begin(), directIndex.lru, it->second.position);
+        return it->second.data;
+    }
+
+    char* data = nullptr;
+    if (directIndex.pages.size() >= directIndex.capacity) {
+        // writes go straight to disk, so an evicted page never needs flushing
+        int victim = directIndex.lru.back();
+        directIndex.lru.pop_back();
+        data = directIndex.pages[victim].data;
+        directIndex.pages.erase(victim);
+    } else {
+        data = static_cast<char*>(aligned_alloc(directPageSize, directPageSize));
+    }
+
+    if (load) {
+        directIndex.misses++;
+        ssize_t got = pread(directIndex.fd, data, directPageSize, (off_t)page * directPageSize);
+        if (got != directPageSize || (directIndex.verify && !directIndex.verify(page, data))) {
+            free(data);
+            return nullptr;
+        }
+    }
+    directIndex.lru.push_front(page);
+    directIndex.pages[page] = {data, directIndex.lru.begin()};
+    return data;
+}
+
+/// Copy the first `bytes` bytes of a page; false past the end of the file or if the page is corrupted
+bool directRead(int page, void* out, size_t bytes) {
+    char* data = directPage(page, true);
+    if (!data) return false;
+    memcpy(out, data, bytes);
+    return true;
+}
+
+/// Replace a page with `bytes` bytes followed by zero padding; written through to disk.
+/// A page whose write fails is dropped from the cache so it is not served from memory.
+bool directWrite(int page, const void* in, size_t bytes) {
+    char* data = directPage(page, false);
+    memset(data, 0, directPageSize);
+    memcpy(data, in, bytes);
+    directIndex.writes++;
+    if (pwrite(directIndex.fd, data, directPageSize, (off_t)page * directPageSize) == directPageSize) return true;
+
+    auto it = directIndex.pages.find(page);
+    directIndex.lru.erase(it->second.position);
+    directIndex.pages.erase(it);
+    free(data);
+    return false;
+}
+
+bool directOpen(const char* filename, size_t cacheBytes, bool (*verify)(int, const char*) = nullptr) {
+    int fd = open(filename, O_RDWR | O_DIRECT);
+    if (fd == -1) {
+        cerr << "Cannot open " << filename << " for direct I/O\n";
+        return false;
+    }
+    directIndex.fd = fd;
+    directIndex.capacity = max<size_t>(cacheBytes / directPageSize, 1);
+    directIndex.verify = verify;
+    directIndex.hits = directIndex.misses = directIndex.writes = 0;
+    return true;
+}
+
+void directClose() {
+    if (!directIndex.active()) return;
+    for (auto &entry : directIndex.pages) free(entry.second.data);
+    directIndex.pages.clear();
+    directIndex.lru.clear();
+    close(directIndex.fd);
+    directIndex.fd = -1;
+}
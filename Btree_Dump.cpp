@@ -0,0 +1,257 @@
+/**
+ * this file has :
+ * 1- a streaming dumper for the index file (text, JSON and Graphviz DOT);
+ *    internal entries are printed as [key, child, keys under child]
+ * 2- physical order (file order, read in large sequential chunks, starting
+ *    with the superblock) and tree order (depth-first from the root of the
+ *    selected index) with paging; in tree order --from is a key rank and the
+ *    dump starts at the leaf holding that key, found by descending the
+ *    subtree counts (--from 0, the default, dumps the whole tree)
+ * 3- int RunDumpCommand (argc, argv) : the "dump" command line tool
+ *
+ * usage: dump <file> [--order tree|physical] [--format text|json|dot]
+ *                    [--from N] [--count N] [--index NAME]
+ **/
+
+enum DumpOrder { PHYSICAL_ORDER, TREE_ORDER };
+enum DumpFormat { TEXT_FORMAT, JSON_FORMAT, DOT_FORMAT };
+
+struct DumpOptions {
+    DumpOrder order = PHYSICAL_ORDER;
+    DumpFormat format = TEXT_FORMAT;
+    long long from = 0;    // physical: first node to print; tree: rank of the first key to print
+    long long count = -1;  // how many nodes to print, -1 = all
+};
+
+/// ----------------- Output writers -----------------
+
+void dumpBegin(ostream &out, DumpFormat format) {
+    if (format == JSON_FORMAT) out << "[\n";
+    else if (format == DOT_FORMAT) out << "digraph btree {\n  node [shape=record];\n";
+}
+
+void dumpEnd(ostream &out, DumpFormat format) {
+    if (format == JSON_FORMAT) out << "\n]\n";
+    else if (format == DOT_FORMAT) out << "}\n";
+}
+
+// the superblock is printed once, ahead of the nodes, in physical order
+void dumpSuperblock(ostream &out, DumpFormat format, const Superblock &sb) {
+    if (format == TEXT_FORMAT) {
+        out << "superblock: version " << sb.version << ", nodes " << sb.nodeCount
+            << ", first free " << sb.freeHead << "\n";
+        for (int i = 0; i < sb.indexCount; i++)
+            out << "index " << sb.catalog[i].name << ": root " << sb.catalog[i].root << "\n";
+        return;
+    }
+    if (format == JSON_FORMAT) {
+        out << "  {\"type\": \"superblock\", \"version\": " << sb.version << ", \"pageSize\": " << sb.pageSize
+            << ", \"nodes\": " << sb.nodeCount << ", \"firstFree\": " << sb.freeHead << ", \"indexes\": [";
+        for (int i = 0; i < sb.indexCount; i++) {
+            if (i) out << ", ";
+            out << "{\"name\": \"" << sb.catalog[i].name << "\", \"root\": " << sb.catalog[i].root << "}";
+        }
+        out << "]}";
+    }
+}
+
+// row is rowSize ints: status, (key, ref) pairs, then subtree counts
+void dumpRow(ostream &out, DumpFormat format, int rrn, const int* row, bool first) {
+    int status = row[0];
+
+    if (format == TEXT_FORMAT) {
+        out << rrn << ": " << status << " ";
+        for (int j = 0; j < 5; j++)
+            out << row[1 + j*2] << " " << row[2 + j*2] << " ";
+        if (status == 1) {
+            out << "| counts";
+            for (int j = 0; j < 5; j++) out << " " << row[countsOffset + j];
+        }
+        out << "\n";
+        return;
+    }
+
+    if (format == JSON_FORMAT) {
+        if (!first) out << ",\n";
+        if (status == -1) {
+            out << "  {\"rrn\": " << rrn << ", \"type\": \"free\", \"nextFree\": " << row[1] << "}";
+            return;
+        }
+        out << "  {\"rrn\": " << rrn << ", \"type\": \"" << (status == 0 ? "leaf" : "internal") << "\", \"entries\": [";
+        bool firstEntry = true;
+        for (int j = 0; j < 5; j++) {
+            if (row[1 + j*2] == -1) continue;
+            if (!firstEntry) out << ", ";
+            out << "[" << row[1 + j*2] << ", " << row[2 + j*2];
+            if (status == 1) out << ", " << row[countsOffset + j];
+            out << "]";
+            firstEntry = false;
+        }
+        out << "]}";
+        return;
+    }
+
+    // DOT: one record node per live tree node, one edge per child pointer
+    if (status == -1) return;
+    out << "  n" << rrn << " [label=\"" << rrn;
+    for (int j = 0; j < 5; j++) {
+        if (row[1 + j*2] == -1) continue;
+        out << "|" << row[1 + j*2];
+        if (status == 0) out << ":" << row[2 + j*2];
+    }
+    out << "\"];\n";
+    if (status == 1) {
+        for (int j = 0; j < 5; j++)
+            if (row[1 + j*2] != -1 && row[2 + j*2] != -1)
+                out << "  n" << rrn << " -> n" << row[2 + j*2] << ";\n";
+    }
+}
+
+/// ----------------- Dumper -----------------
+
+/// Stream the index file to `out`; memory use does not depend on the file size.
+/// A file created with DIRECT_IO is read through OpenIndex in its paged layout
+/// unless the caller already opened it in direct or memory mode.
+void DumpIndexFile(const char* filename, const DumpOptions &opt, ostream &out) {
+    fstream file(filename, ios::in | ios::binary);
+    if (!file) {
+        cerr << "Cannot open file\n";  // keep JSON / DOT output on stdout clean
+        return;
+    }
+
+    bool openedHere = false;
+    if (!directIndex.active() && !memoryIndex.active()) {
+        Superblock probe;
+        if (readSuperblock(file, probe) && probe.pageSize == directPageSize) {
+            if (!OpenIndex(filename, DIRECT_IO)) {
+                cerr << "Cannot open file\n";
+                return;
+            }
+            openedHere = true;
+        }
+    }
+
+    long long printed = 0;
+    bool first = true;
+    dumpBegin(out, opt.format);
+
+    if (opt.order == PHYSICAL_ORDER) {
+        Superblock sb;
+        if (opt.from == 0 && opt.format != DOT_FORMAT && readSuperblock(file, sb)) {
+            dumpSuperblock(out, opt.format, sb);
+            first = false;
+        }
+
+        // position p in physical order is RRN p + 1, so paging is a single seek
+        const int chunkRows = 4096;
+        vector<int> rows;
+        for (long long start = opt.from + 1; opt.count == -1 || printed < opt.count; start += chunkRows) {
+            int got = readRowChunk(file, (int)start, chunkRows, rows);
+            for (int i = 0; i < got && (opt.count == -1 || printed < opt.count); i++) {
+                dumpRow(out, opt.format, (int)start + i, &rows[(size_t)i * rowSize], first);
+                first = false;
+                printed++;
+            }
+            if (got < chunkRows) break;
+        }
+    } else {
+        // depth-first from the root; the stack never holds more than height * M RRNs
+        vector<int> stack;
+        vector<int> row(rowSize, -1);
+        int start = GetRootRRN(file);
+
+        // descend to the leaf holding key rank `from`, leaving every subtree to the
+        // right of the path on the stack, so nothing before the start is read
+        long long rank = opt.from;
+        while (start != -1 && rank > 0) {
+            row.assign(rowSize, -1);
+            if (!readRow(file, start, row.data()) || row[0] == -1) break;
+            if (row[0] == 0) {
+                // only a root leaf gets here; its key count bounds the rank
+                int keys = 0;
+                for (int j = 0; j < 5; j++) if (row[1 + j*2] != -1) keys++;
+                if (rank >= keys) start = -1;
+                break;
+            }
+            int next = -1;
+            for (int j = 0; j < 5 && next == -1; j++) {
+                if (row[1 + j*2] == -1 || row[2 + j*2] == -1) continue;
+                if (rank < row[countsOffset + j]) {
+                    next = row[2 + j*2];
+                    for (int k = 4; k > j; k--)
+                        if (row[1 + k*2] != -1 && row[2 + k*2] != -1)
+                            stack.push_back(row[2 + k*2]);
+                } else {
+                    rank -= row[countsOffset + j];
+                }
+            }
+            start = next;   // -1 when `from` is past the last key
+        }
+        if (start != -1) stack.push_back(start);
+
+        while (!stack.empty() && (opt.count == -1 || printed < opt.count)) {
+            int rrn = stack.back();
+            stack.pop_back();
+            row.assign(rowSize, -1);
+            if (!readRow(file, rrn, row.data()) || row[0] == -1) continue;
+
+            dumpRow(out, opt.format, rrn, row.data(), first);
+            first = false;
+            printed++;
+
+            if (row[0] == 1) {
+                // push children right to left so the leftmost is visited first
+                for (int j = 4; j >= 0; j--)
+                    if (row[1 + j*2] != -1 && row[2 + j*2] != -1)
+                        stack.push_back(row[2 + j*2]);
+            }
+        }
+    }
+
+    dumpEnd(out, opt.format);
+    if (openedHere) CloseIndex();
+    file.close();
+}
+
+/// ----------------- Command line -----------------
+
+/// args are everything after "dump"; returns the process exit code
+int RunDumpCommand(int argc, char** argv) {
+    if (argc < 1) {
+        cerr << "usage: dump <file> [--order tree|physical] [--format text|json|dot] [--from N] [--count N] [--index NAME]\n";
+        return 1;
+    }
+
+    DumpOptions opt;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << arg << "\n";
+            return 1;
+        }
+        string value = argv[++i];
+
+        if (arg == "--order") {
+            if (value == "tree") opt.order = TREE_ORDER;
+            else if (value == "physical") opt.order = PHYSICAL_ORDER;
+            else { cerr << "Unknown order: " << value << "\n"; return 1; }
+        } else if (arg == "--format") {
+            if (value == "text") opt.format = TEXT_FORMAT;
+            else if (value == "json") opt.format = JSON_FORMAT;
+            else if (value == "dot") opt.format = DOT_FORMAT;
+            else { cerr << "Unknown format: " << value << "\n"; return 1; }
+        } else if (arg == "--from") {
+            opt.from = atoll(value.c_str());
+        } else if (arg == "--count") {
+            opt.count = atoll(value.c_str());
+        } else if (arg == "--index") {
+            UseIndex(value.c_str());
+        } else {
+            cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    DumpIndexFile(argv[0], opt, cout);
+    return 0;
+}
@@ -0,0 +1,580 @@
+/**
+ * this file has :
+ * the B-tree engine templated on the key type, for keys that do not fit the
+ * int-only index (IndexFile.bin) such as the string IDs of Doctors and Appointments
+ * 1- KeyTraits<Key> : the comparator and key codec for int32, int64 and fixed-width strings
+ * 2- GenericNode<Key> : a node layout sized at compile time for the key width
+ * 3- void CreateGenericIndexFile<Key> (Char* filename)
+ * 4- int InsertGenericRecord<Key> (Char* filename, Key key, int64_t Reference)
+ * 5- int64_t SearchGenericRecord<Key> (Char* filename, Key key)
+ * 6- bool DeleteGenericRecord<Key> (Char* filename, Key key)
+ * 7- bool BulkLoadGenericIndex<Key> (Char* filename, vector<pair<Key, int64_t>> entries)
+ *
+ * the tree follows the same rules as the int index : internal entries store the
+ * max key of their child, the RRN of the child and the number of keys under it.
+ * leaf references are 64-bit so they can hold data file offsets past 2 GiB.
+ * a node other than the root stays at least half full : a delete that leaves it
+ * short borrows one entry from a sibling, or merges it into the sibling.
+ **/
+
+/// ----------------- Key types -----------------
+
+/// Fixed-width string key, NUL padded so memcmp orders it like strcmp
+template <size_t N>
+struct FixedKey {
+    char bytes[N];
+};
+
+template <typename Key> struct KeyTraits;
+
+template <> struct KeyTraits<int32_t> {
+    static bool less(int32_t a, int32_t b) { return a < b; }
+    static int32_t encode(long long value) { return (int32_t)value; }
+    static string toString(int32_t key) { return to_string(key); }
+};
+
+template <> struct KeyTraits<int64_t> {
+    static bool less(int64_t a, int64_t b) { return a < b; }
+    static int64_t encode(long long value) { return (int64_t)value; }
+    static string toString(int64_t key) { return to_string(key); }
+};
+
+template <size_t N> struct KeyTraits<FixedKey<N>> {
+    static bool less(const FixedKey<N> &a, const FixedKey<N> &b) {
+        return memcmp(a.bytes, b.bytes, N) < 0;
+    }
+    // longer strings are cut to N bytes
+    static FixedKey<N> encode(const char* text) {
+        FixedKey<N> key;
+        memset(key.bytes, 0, N);
+        strncpy(key.bytes, text, N);
+        return key;
+    }
+    static string toString(const FixedKey<N> &key) {
+        return string(key.bytes, strnlen(key.bytes, N));
+    }
+};
+
+template <typename Key>
+bool keysEqual(const Key &a, const Key &b) {
+    return !KeyTraits<Key>::less(a, b) && !KeyTraits<Key>::less(b, a);
+}
+
+/// ----------------- Node layout -----------------
+
+/// Target on-disk node size; the fan-out is whatever fits for the key width
+const int genericPageTarget = 512;
+
+template <typename Key>
+struct GenericNode {
+    // header (16 bytes) + keys + references + subtree counts + checksum
+    static constexpr int capacity =
+        (genericPageTarget - 4 * (int)sizeof(int32_t) - (int)sizeof(uint32_t)) /
+        (int)(sizeof(Key) + sizeof(int64_t) + sizeof(int32_t));
+    static_assert(capacity >= 4, "key type too wide for the generic node layout");
+
+    int32_t status;          // -1 empty, 0 leaf, 1 internal
+    int32_t used;            // number of live entries
+    int32_t next;            // next free node while on the free list
+    int32_t reserved;
+    Key keys[capacity];
+    int64_t refs[capacity];   // record reference in a leaf, child RRN in an internal node
+    int32_t counts[capacity]; // keys under each child (internal nodes only)
+    uint32_t crc;
+};
+
+/// Node 0 of a generic index file
+struct GenericHeader {
+    char magic[8];           // "GBTREE2", version 1 had 32-bit references
+    int32_t keyWidth;        // sizeof(Key) the file was created with
+    int32_t root;            // RRN of the root node
+    int32_t freeHead;        // first free node, -1 when the file must grow
+    int32_t nodeCount;       // nodes in the file including node 0
+    uint32_t crc;
+};
+
+template <typename Key>
+GenericNode<Key> emptyGenericNode(int status) {
+    GenericNode<Key> node;
+    memset(&node, 0, sizeof(node)); // padding included, so checksums are stable
+    node.status = status;
+    node.next = -1;
+    return node;
+}
+
+template <typename Key>
+constexpr streamoff genericNodeOffset(int rrn) {
+    return (streamoff)rrn * (streamoff)sizeof(GenericNode<Key>);
+}
+
+/// ----------------- Node IO -----------------
+
+template <typename Key>
+void writeGenericHeader(fstream &file, GenericHeader &header) {
+    header.crc = crc32c(&header, offsetof(GenericHeader, crc));
+    file.seekp(0, ios::beg);
+    file.write(reinterpret_cast<char*>(&header), sizeof(header));
+}
+
+template <typename Key>
+bool readGenericHeader(fstream &file, GenericHeader &header) {
+    file.seekg(0, ios::beg);
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        file.clear();
+        return false;
+    }
+    if (memcmp(header.magic, "GBTREE2", 8) != 0 || header.keyWidth != (int32_t)sizeof(Key)) {
+        cerr << "Not a generic index for this key type\n";
+        return false;
+    }
+    if (header.crc != crc32c(&header, offsetof(GenericHeader, crc))) {
+        checksumFailures++;
+        cerr << "Checksum mismatch in generic index header\n";
+        return false;
+    }
+    return true;
+}
+
+template <typename Key>
+void writeGenericNode(fstream &file, int rrn, GenericNode<Key> &node) {
+    node.crc = crc32c(&node, offsetof(GenericNode<Key>, crc));
+    file.seekp(genericNodeOffset<Key>(rrn), ios::beg);
+    file.write(reinterpret_cast<char*>(&node), sizeof(node));
+}
+
+template <typename Key>
+GenericNode<Key> readGenericNode(fstream &file, int rrn) {
+    GenericNode<Key> node = emptyGenericNode<Key>(-1);
+    file.seekg(genericNodeOffset<Key>(rrn), ios::beg);
+    if (!file.read(reinterpret_cast<char*>(&node), sizeof(node))) {
+        file.clear();
+        return emptyGenericNode<Key>(-1);
+    }
+    if (node.crc != crc32c(&node, offsetof(GenericNode<Key>, crc))) {
+        checksumFailures++;
+        cerr << "Checksum mismatch in node " << rrn << "\n";
+        return emptyGenericNode<Key>(-1);   // like an unreadable node
+    }
+    return node;
+}
+
+/// ----------------- Free list -----------------
+
+template <typename Key>
+int allocGenericNode(fstream &file, GenericHeader &header, int status) {
+    int rrn = header.freeHead;
+    if (rrn != -1) {
+        header.freeHead = readGenericNode<Key>(file, rrn).next;
+    } else {
+        rrn = header.nodeCount++; // grow the file by one node
+    }
+    GenericNode<Key> node = emptyGenericNode<Key>(status);
+    writeGenericNode(file, rrn, node);
+    return rrn;
+}
+
+template <typename Key>
+void releaseGenericNode(fstream &file, GenericHeader &header, int rrn) {
+    GenericNode<Key> node = emptyGenericNode<Key>(-1);
+    node.next = header.freeHead;
+    writeGenericNode(file, rrn, node);
+    header.freeHead = rrn;
+}
+
+/// ----------------- Node helpers -----------------
+
+// keys under a node: entries for a leaf, sum of child counts for an internal node
+template <typename Key>
+int genericSubtreeCount(const GenericNode<Key> &node) {
+    if (node.status != 1) return node.used;
+    int total = 0;
+    for (int i = 0; i < node.used; i++) total += node.counts[i];
+    return total;
+}
+
+// first slot whose key is >= key (node.used when all keys are smaller)
+template <typename Key>
+int genericLowerBound(const GenericNode<Key> &node, const Key &key) {
+    int lo = 0, hi = node.used;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (KeyTraits<Key>::less(node.keys[mid], key)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+template <typename Key>
+void genericInsertAt(GenericNode<Key> &node, int pos, const Key &key, int64_t ref, int count) {
+    for (int i = node.used; i > pos; i--) {
+        node.keys[i] = node.keys[i - 1];
+        node.refs[i] = node.refs[i - 1];
+        node.counts[i] = node.counts[i - 1];
+    }
+    node.keys[pos] = key;
+    node.refs[pos] = ref;
+    node.counts[pos] = count;
+    node.used++;
+}
+
+template <typename Key>
+void genericEraseAt(GenericNode<Key> &node, int pos) {
+    for (int i = pos; i < node.used - 1; i++) {
+        node.keys[i] = node.keys[i + 1];
+        node.refs[i] = node.refs[i + 1];
+        node.counts[i] = node.counts[i + 1];
+    }
+    node.used--;
+}
+
+/// ----------------- Create -----------------
+
+template <typename Key>
+void CreateGenericIndexFile(const char* filename) {
+    fstream file(filename, ios::in | ios::out | ios::binary | ios::trunc);
+    if (!file) {
+        cerr << "Cannot create " << filename << "\n";
+        return;
+    }
+
+    GenericHeader header;
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, "GBTREE2");
+    header.keyWidth = sizeof(Key);
+    header.root = 1;
+    header.freeHead = -1;
+    header.nodeCount = 2;
+
+    // node 0 holds the header, node 1 starts as an empty leaf root
+    GenericNode<Key> pad = emptyGenericNode<Key>(-1);
+    writeGenericNode(file, 0, pad);
+    writeGenericHeader<Key>(file, header);
+    GenericNode<Key> root = emptyGenericNode<Key>(0);
+    writeGenericNode(file, 1, root);
+    file.close();
+}
+
+/// ----------------- Search -----------------
+
+template <typename Key>
+int64_t SearchGenericRecord(const char* filename, const Key &key) {
+    fstream file(filename, ios::in | ios::binary);
+    GenericHeader header;
+    if (!file || !readGenericHeader<Key>(file, header)) return -1;
+
+    int current = header.root;
+    while (true) {
+        GenericNode<Key> node = readGenericNode<Key>(file, current);
+        int pos = genericLowerBound(node, key);
+        if (pos == node.used) return -1; // larger than every key in this subtree
+
+        if (node.status == 1) {
+            current = (int)node.refs[pos];
+            continue;
+        }
+        if (node.status == 0 && keysEqual(node.keys[pos], key)) return node.refs[pos];
+        return -1;
+    }
+}
+
+/// ----------------- Insert -----------------
+
+template <typename Key>
+struct GenericSplit {
+    int rightRRN = -1;  // new right sibling, -1 when the node did not split
+    Key leftMax;        // max key left in the node
+    int leftCount = 0;
+    Key rightMax;
+    int rightCount = 0;
+    bool failed = false; // a node on the path could not be read; nothing was written
+};
+
+// Insert into the subtree at rrn; reports the node's new max/count and any split
+template <typename Key>
+GenericSplit<Key> insertGeneric(fstream &file, GenericHeader &header, int rrn,
+                                const Key &key, int64_t reference) {
+    const int capacity = GenericNode<Key>::capacity;
+    GenericNode<Key> node = readGenericNode<Key>(file, rrn);
+    if (node.status == -1 || (node.status == 1 && node.used == 0)) {
+        GenericSplit<Key> failed;
+        failed.failed = true;
+        return failed;
+    }
+    int pos = genericLowerBound(node, key);
+
+    // the node gets one extra slot while it is being split
+    vector<Key> keys(node.keys, node.keys + node.used);
+    vector<int64_t> refs(node.refs, node.refs + node.used);
+    vector<int> counts(node.counts, node.counts + node.used);
+
+    if (node.status == 0) {
+        keys.insert(keys.begin() + pos, key);
+        refs.insert(refs.begin() + pos, reference);
+        counts.insert(counts.begin() + pos, -1);
+    } else {
+        // keys above every separator go to the last child, whose max grows
+        if (pos == node.used) pos = node.used - 1;
+        GenericSplit<Key> child = insertGeneric(file, header, (int)node.refs[pos], key, reference);
+        if (child.failed) return child;
+        keys[pos] = child.leftMax;
+        counts[pos] = child.leftCount;
+        if (child.rightRRN != -1) {
+            keys.insert(keys.begin() + pos + 1, child.rightMax);
+            refs.insert(refs.begin() + pos + 1, child.rightRRN);
+            counts.insert(counts.begin() + pos + 1, child.rightCount);
+        }
+    }
+
+    GenericSplit<Key> result;
+    int total = (int)keys.size();
+    int leftSize = total <= capacity ? total : total / 2;
+
+    node.used = leftSize;
+    for (int i = 0; i < leftSize; i++) {
+        node.keys[i] = keys[i];
+        node.refs[i] = refs[i];
+        node.counts[i] = counts[i];
+    }
+    writeGenericNode(file, rrn, node);
+    result.leftMax = node.keys[leftSize - 1];
+    result.leftCount = genericSubtreeCount(node);
+
+    if (total > capacity) {
+        int rightRRN = allocGenericNode<Key>(file, header, node.status);
+        GenericNode<Key> right = emptyGenericNode<Key>(node.status);
+        right.used = total - leftSize;
+        for (int i = 0; i < right.used; i++) {
+            right.keys[i] = keys[leftSize + i];
+            right.refs[i] = refs[leftSize + i];
+            right.counts[i] = counts[leftSize + i];
+        }
+        writeGenericNode(file, rightRRN, right);
+        result.rightRRN = rightRRN;
+        result.rightMax = right.keys[right.used - 1];
+        result.rightCount = genericSubtreeCount(right);
+    }
+    return result;
+}
+
+template <typename Key>
+int InsertGenericRecord(const char* filename, const Key &key, int64_t Reference) {
+    fstream file(filename, ios::in | ios::out | ios::binary);
+    GenericHeader header;
+    if (!file || !readGenericHeader<Key>(file, header)) return -1;
+
+    GenericSplit<Key> split = insertGeneric(file, header, header.root, key, Reference);
+    if (split.failed) {
+        file.close();
+        return -1;
+    }
+    if (split.rightRRN != -1) {
+        // root split: the new root goes anywhere, the header just points at it
+        int newRoot = allocGenericNode<Key>(file, header, 1);
+        GenericNode<Key> root = emptyGenericNode<Key>(1);
+        genericInsertAt(root, 0, split.leftMax, header.root, split.leftCount);
+        genericInsertAt(root, 1, split.rightMax, split.rightRRN, split.rightCount);
+        writeGenericNode(file, newRoot, root);
+        header.root = newRoot;
+    }
+    writeGenericHeader<Key>(file, header);
+    file.close();
+    return header.root;
+}
+
+/// ----------------- Bulk load -----------------
+
+// Rebuild the file from entries sorted by key with no duplicates, one level at a
+// time from the leaves up. Each level is spread evenly over as few nodes as hold
+// it, so every node is at least half full like after a run of inserts.
+template <typename Key>
+bool BulkLoadGenericIndex(const char* filename, const vector<pair<Key, int64_t>> &entries) {
+    CreateGenericIndexFile<Key>(filename);
+    fstream file(filename, ios::in | ios::out | ios::binary);
+    GenericHeader header;
+    if (!file || !readGenericHeader<Key>(file, header)) return false;
+    if (entries.empty()) return true;
+
+    const int capacity = GenericNode<Key>::capacity;
+    struct LevelEntry {
+        Key key;
+        int64_t ref;
+        int count;
+    };
+    vector<LevelEntry> level;
+    level.reserve(entries.size());
+    for (const auto &entry : entries) level.push_back({entry.first, entry.second, -1});
+
+    int status = 0;
+    int next = 1; // node 1 onwards; the old empty root is overwritten
+    while (true) {
+        int total = (int)level.size();
+        int nodes = (total + capacity - 1) / capacity;
+        vector<LevelEntry> parents;
+        parents.reserve(nodes);
+        int begin = 0;
+        for (int n = 0; n < nodes; n++) {
+            int end = (int)((long long)total * (n + 1) / nodes);
+            GenericNode<Key> node = emptyGenericNode<Key>(status);
+            for (int i = begin; i < end; i++)
+                genericInsertAt(node, node.used, level[i].key, level[i].ref, level[i].count);
+            int rrn = next++;
+            writeGenericNode(file, rrn, node);
+            parents.push_back({node.keys[node.used - 1], rrn, genericSubtreeCount(node)});
+            begin = end;
+        }
+        if (nodes == 1) {
+            header.root = (int)parents[0].ref;
+            break;
+        }
+        level.swap(parents);
+        status = 1;
+    }
+
+    header.freeHead = -1;
+    header.nodeCount = next;
+    writeGenericHeader<Key>(file, header);
+    file.close();
+    return !file.fail();
+}
+
+/// ----------------- Delete -----------------
+
+// A split leaves both halves at least this full, and deletes keep every node but the root there
+template <typename Key>
+constexpr int genericMinUsed() {
+    return GenericNode<Key>::capacity / 2;
+}
+
+// Point the parent entry at pos at the child's current max key and key count
+template <typename Key>
+void refreshGenericEntry(GenericNode<Key> &parent, int pos, const GenericNode<Key> &child) {
+    parent.keys[pos] = child.keys[child.used - 1];
+    parent.counts[pos] = genericSubtreeCount(child);
+}
+
+// The child at pos of node fell below the minimum fill: borrow one entry from a
+// sibling that can spare it, otherwise merge the child with a sibling.
+// Only node's entries change in memory; the caller writes node.
+template <typename Key>
+void rebalanceGenericChild(fstream &file, GenericHeader &header, GenericNode<Key> &node,
+                           int pos, GenericNode<Key> &child) {
+    const int minUsed = genericMinUsed<Key>();
+
+    if (node.used == 1) {
+        // no sibling to work with; the root collapse in DeleteGenericRecord handles this
+        if (child.used == 0) {
+            releaseGenericNode<Key>(file, header, (int)node.refs[pos]);
+            genericEraseAt(node, pos);
+        } else {
+            refreshGenericEntry(node, pos, child);
+        }
+        return;
+    }
+
+    GenericNode<Key> left, right;
+    bool haveLeft = pos > 0, haveRight = pos + 1 < node.used;
+    if (haveLeft) left = readGenericNode<Key>(file, (int)node.refs[pos - 1]);
+    if (haveLeft && left.status == child.status && left.used > minUsed) {
+        // the left sibling's largest entry becomes the child's smallest
+        int last = left.used - 1;
+        genericInsertAt(child, 0, left.keys[last], left.refs[last], left.counts[last]);
+        left.used--;
+        writeGenericNode(file, (int)node.refs[pos - 1], left);
+        writeGenericNode(file, (int)node.refs[pos], child);
+        refreshGenericEntry(node, pos - 1, left);
+        refreshGenericEntry(node, pos, child);
+        return;
+    }
+    if (haveRight) right = readGenericNode<Key>(file, (int)node.refs[pos + 1]);
+    if (haveRight && right.status == child.status && right.used > minUsed) {
+        // the right sibling's smallest entry becomes the child's largest
+        genericInsertAt(child, child.used, right.keys[0], right.refs[0], right.counts[0]);
+        genericEraseAt(right, 0);
+        writeGenericNode(file, (int)node.refs[pos + 1], right);
+        writeGenericNode(file, (int)node.refs[pos], child);
+        refreshGenericEntry(node, pos, child);
+        refreshGenericEntry(node, pos + 1, right);
+        return;
+    }
+
+    // merge the pair into its left node; together they hold fewer than capacity entries
+    int l = haveLeft ? pos - 1 : pos;
+    GenericNode<Key> &into = haveLeft ? left : child;
+    GenericNode<Key> &from = haveLeft ? child : right;
+    if (into.status != from.status) {
+        // unreadable sibling: keep the child as it is rather than lose its keys
+        if (child.used == 0) {
+            releaseGenericNode<Key>(file, header, (int)node.refs[pos]);
+            genericEraseAt(node, pos);
+        } else {
+            writeGenericNode(file, (int)node.refs[pos], child);
+            refreshGenericEntry(node, pos, child);
+        }
+        return;
+    }
+    for (int i = 0; i < from.used; i++)
+        genericInsertAt(into, into.used, from.keys[i], from.refs[i], from.counts[i]);
+    releaseGenericNode<Key>(file, header, (int)node.refs[l + 1]);
+    genericEraseAt(node, l + 1);
+    if (into.used == 0) {
+        releaseGenericNode<Key>(file, header, (int)node.refs[l]);
+        genericEraseAt(node, l);
+        return;
+    }
+    writeGenericNode(file, (int)node.refs[l], into);
+    refreshGenericEntry(node, l, into);
+}
+
+// Remove key from the subtree at rrn; returns false when the key is not there
+template <typename Key>
+bool deleteGeneric(fstream &file, GenericHeader &header, int rrn, const Key &key) {
+    GenericNode<Key> node = readGenericNode<Key>(file, rrn);
+    int pos = genericLowerBound(node, key);
+    if (pos == node.used) return false;
+
+    if (node.status == 0) {
+        if (!keysEqual(node.keys[pos], key)) return false;
+        genericEraseAt(node, pos);
+        writeGenericNode(file, rrn, node);
+        return true;
+    }
+
+    int childRRN = (int)node.refs[pos];
+    if (!deleteGeneric(file, header, childRRN, key)) return false;
+
+    GenericNode<Key> child = readGenericNode<Key>(file, childRRN);
+    if (child.status == -1) return true;   // unreadable now; leave the parent entry alone
+    if (child.used < genericMinUsed<Key>()) rebalanceGenericChild(file, header, node, pos, child);
+    else refreshGenericEntry(node, pos, child);
+    writeGenericNode(file, rrn, node);
+    return true;
+}
+
+template <typename Key>
+bool DeleteGenericRecord(const char* filename, const Key &key) {
+    fstream file(filename, ios::in | ios::out | ios::binary);
+    GenericHeader header;
+    if (!file || !readGenericHeader<Key>(file, header)) return false;
+
+    if (!deleteGeneric(file, header, header.root, key)) {
+        file.close();
+        return false;
+    }
+
+    // collapse roots that are left with a single child (or none)
+    while (true) {
+        GenericNode<Key> root = readGenericNode<Key>(file, header.root);
+        if (root.status != 1 || root.used > 1) break;
+        int oldRoot = header.root;
+        if (root.used == 1) {
+            header.root = (int)root.refs[0];
+        } else {
+            header.root = allocGenericNode<Key>(file, header, 0);
+        }
+        releaseGenericNode<Key>(file, header, oldRoot);
+    }
+
+    writeGenericHeader<Key>(file, header);
+    file.close();
+    return true;
+}
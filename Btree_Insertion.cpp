@@ -9,62 +9,90 @@ using namespace std;
 
 // --- Constants ---
 const int M = 5;
-const int ROW_SIZE = 11; // Matches Build.cpp
+const int ROW_SIZE = 16;     // Matches Build.cpp
+const int ENTRY_FIELDS = 11; // status + (key, reference) pairs; subtree counts follow
+
+// Buffer slot holding the subtree key count for the pair whose key is at slot i
+inline int countSlot(int i) {
+    return ENTRY_FIELDS + (i - 1) / 2;
+}
 
 struct RecordEntry {
     int key;
     int reference;
+    int count = -1; // keys under `reference` (internal entries only)
     bool operator<(const RecordEntry &other) const {
         return key < other.key;
     }
 };
 
 // --- Raw Buffer Helpers ---
-void ReadNodeRaw(const char *filename, int nodeIndex, int *buffer) {
-    ifstream file(filename, ios::binary);
-    file.seekg(nodeIndex * ROW_SIZE * sizeof(int), ios::beg);
-    file.read(reinterpret_cast<char *>(buffer), ROW_SIZE * sizeof(int));
+// readRow/writeRow (BuildABtree.cpp) add and verify the per-row CRC32C
+// Returns false (buffer untouched) when the row cannot be read or is corrupted
+bool ReadNodeRaw(const char *filename, int nodeIndex, int *buffer) {
+    ifstream file;
+    if (!streamsBypassed()) file.open(filename, ios::binary);
+    bool ok = readRow(file, nodeIndex, buffer);
     file.close();
+    return ok;
 }
 
-void WriteNodeRaw(const char *filename, int nodeIndex, int *buffer) {
-    ofstream file(filename, ios::binary | ios::in | ios::out);
-    file.seekp(nodeIndex * ROW_SIZE * sizeof(int), ios::beg);
-    file.write(reinterpret_cast<char *>(buffer), ROW_SIZE * sizeof(int));
+bool WriteNodeRaw(const char *filename, int nodeIndex, int *buffer) {
+    ofstream file;
+    if (!streamsBypassed()) file.open(filename, ios::binary | ios::in | ios::out);
+    bool ok = writeRow(file, nodeIndex, buffer);
     file.close();
+    return ok;
 }
 
 int GetFreeNode(const char *filename) {
-    int *buffer = new int[ROW_SIZE];
-
-    // Read Header (Node 0)
-    ReadNodeRaw(filename, 0, buffer);
-    int freeNode = buffer[1];
+    // Read Header (Superblock), cached between allocations
+    Superblock sb;
+    if (!cachedSuperblock(filename, sb)) return -1;
+    int freeNode = sb.freeHead;
 
     if (freeNode == -1) {
-        delete[] buffer;
         return -1; // Disk Full
     }
 
+    fstream file;
+    if (!streamsBypassed()) file.open(filename, ios::binary | ios::in | ios::out);
+
     // Read the free node to find the next one
     int *freeNodeBuff = new int[ROW_SIZE];
-    ReadNodeRaw(filename, freeNode, freeNodeBuff);
+    if (!readRow(file, freeNode, freeNodeBuff)) { delete[] freeNodeBuff; return -1; } // broken free list
     int nextFree = freeNodeBuff[1];
 
     // Update Header
-    buffer[1] = nextFree;
-    WriteNodeRaw(filename, 0, buffer);
+    sb.freeHead = nextFree;
+    if (!writeSuperblock(file, sb)) { delete[] freeNodeBuff; return -1; } // node stays free
+    rememberSuperblock(filename, sb);
 
     // Clean the allocated node
     for (int i = 0; i < ROW_SIZE; i++) freeNodeBuff[i] = -1;
     freeNodeBuff[0] = 0; // Default to Leaf status
-    WriteNodeRaw(filename, freeNode, freeNodeBuff);
+    writeRow(file, freeNode, freeNodeBuff);
 
-    delete[] buffer;
     delete[] freeNodeBuff;
+    file.close();
     return freeNode;
 }
 
+// True when the free list still holds at least `needed` nodes
+bool HasFreeNodes(const char *filename, int needed) {
+    Superblock sb;
+    if (!cachedSuperblock(filename, sb)) return false;
+    ifstream file;
+    if (!streamsBypassed()) file.open(filename, ios::binary);
+    int node = sb.freeHead;
+    int row[ROW_SIZE];
+    for (int i = 0; i < needed; i++) {
+        if (node == -1 || !readRow(file, node, row)) return false;
+        node = row[1];
+    }
+    return true;
+}
+
 // --- Propagation Helper ---
 void propagateMaxKeyUpdate(const char* filename, const vector<int>& path, int childRRN, int newMax) {
     int currentChildRRN = childRRN;
@@ -73,18 +101,18 @@ void propagateMaxKeyUpdate(const char* filename, const vector<int>& path, int ch
     for (int i = path.size() - 2; i >= 0; i--) {
         int parentRRN = path[i];
         int *parentBuf = new int[ROW_SIZE];
-        ReadNodeRaw(filename, parentRRN, parentBuf);
+        if (!ReadNodeRaw(filename, parentRRN, parentBuf)) { delete[] parentBuf; return; }
 
         bool updated = false;
         bool isLastKey = false;
 
-        for (int k = 1; k < ROW_SIZE; k += 2) {
+        for (int k = 1; k < ENTRY_FIELDS; k += 2) {
             if (parentBuf[k+1] == currentChildRRN) {
                 if (parentBuf[k] != currentMax) {
                     parentBuf[k] = currentMax;
                     updated = true;
                 }
-                if (k + 2 >= ROW_SIZE || parentBuf[k+2] == -1) {
+                if (k + 2 >= ENTRY_FIELDS || parentBuf[k+2] == -1) {
                     isLastKey = true;
                 }
                 break;
@@ -99,19 +127,28 @@ void propagateMaxKeyUpdate(const char* filename, const vector<int>& path, int ch
     }
 }
 
+// --- Subtree Count Helper ---
+// Total keys under entries [from, to) of an internal node
+int sumCounts(const vector<RecordEntry> &entries, size_t from, size_t to) {
+    int total = 0;
+    for (size_t i = from; i < to; i++) total += entries[i].count;
+    return total;
+}
+
 // --- Recursive Internal Insert Function ---
-bool insertIntoInternal(const char *filename, int parentRRN, int upKey, int upRef, vector<int> &path) {
+// upCount is the number of keys under upRef
+bool insertIntoInternal(const char *filename, int parentRRN, int upKey, int upRef, int upCount, vector<int> &path) {
     int *parentBuf = new int[ROW_SIZE];
-    ReadNodeRaw(filename, parentRRN, parentBuf);
+    if (!ReadNodeRaw(filename, parentRRN, parentBuf)) { delete[] parentBuf; return false; }
 
     vector<RecordEntry> entries;
-    for (int i = 1; i < ROW_SIZE; i += 2) {
+    for (int i = 1; i < ENTRY_FIELDS; i += 2) {
         if (parentBuf[i] != -1) {
-            entries.push_back({parentBuf[i], parentBuf[i + 1]});
+            entries.push_back({parentBuf[i], parentBuf[i + 1], parentBuf[countSlot(i)]});
         }
     }
 
-    entries.push_back({upKey, upRef});
+    entries.push_back({upKey, upRef, upCount});
     sort(entries.begin(), entries.end());
 
     // 1: Fits in Node
@@ -120,6 +157,7 @@ bool insertIntoInternal(const char *filename, int parentRRN, int upKey, int upRe
         parentBuf[0] = 1;
         int idx = 1;
         for (const auto &entry : entries) {
+            parentBuf[countSlot(idx)] = entry.count;
             parentBuf[idx++] = entry.key;
             parentBuf[idx++] = entry.reference;
         }
@@ -137,23 +175,21 @@ bool insertIntoInternal(const char *filename, int parentRRN, int upKey, int upRe
     int maxLeft = entries[mid - 1].key;
     int maxRight = entries.back().key;
 
-    // --- FIX: Check Root Split FIRST ---
-    if (parentRRN == 1) {
-        // Root Split: Allocate Left (2) then Right (3)
-        int leftNodeIndex = GetFreeNode(filename);
+    // --- Root Split: the old root keeps the left half, a new root goes on top ---
+    if (parentRRN == GetRootRRN(filename)) {
         int rightNodeIndex = GetFreeNode(filename);
+        int newRootIndex = GetFreeNode(filename);
 
-        // Prepare Left Node (contains first half)
-        int *leftBuf = new int[ROW_SIZE];
-        for (int k = 0; k < ROW_SIZE; k++) leftBuf[k] = -1;
-        leftBuf[0] = 1; // Internal
+        // Update Current (Left, still the old root RRN)
+        for (int k = 1; k < ROW_SIZE; k++) parentBuf[k] = -1;
+        parentBuf[0] = 1; // Internal
         int idx = 1;
         for(int i=0; i<mid; i++) {
-            leftBuf[idx++] = entries[i].key;
-            leftBuf[idx++] = entries[i].reference;
+            parentBuf[countSlot(idx)] = entries[i].count;
+            parentBuf[idx++] = entries[i].key;
+            parentBuf[idx++] = entries[i].reference;
         }
-        WriteNodeRaw(filename, leftNodeIndex, leftBuf);
-        delete[] leftBuf;
+        WriteNodeRaw(filename, parentRRN, parentBuf);
 
         // Prepare Right Node (contains second half)
         int *rightBuf = new int[ROW_SIZE];
@@ -161,22 +197,27 @@ bool insertIntoInternal(const char *filename, int parentRRN, int upKey, int upRe
         rightBuf[0] = 1; // Internal
         idx = 1;
         for(size_t i=mid; i<entries.size(); i++) {
+            rightBuf[countSlot(idx)] = entries[i].count;
             rightBuf[idx++] = entries[i].key;
             rightBuf[idx++] = entries[i].reference;
         }
         WriteNodeRaw(filename, rightNodeIndex, rightBuf);
         delete[] rightBuf;
 
-        // Update Root (1) to point to Left (2) and Right (3)
+        // New Root points to Left then Right
         int *rootBuf = new int[ROW_SIZE];
         for (int k = 0; k < ROW_SIZE; k++) rootBuf[k] = -1;
         rootBuf[0] = 1; // Internal
-        rootBuf[1] = maxLeft; rootBuf[2] = leftNodeIndex;
+        rootBuf[1] = maxLeft; rootBuf[2] = parentRRN;
         rootBuf[3] = maxRight; rootBuf[4] = rightNodeIndex;
+        rootBuf[countSlot(1)] = sumCounts(entries, 0, mid);
+        rootBuf[countSlot(3)] = sumCounts(entries, mid, entries.size());
+        WriteNodeRaw(filename, newRootIndex, rootBuf);
 
-        WriteNodeRaw(filename, 1, rootBuf);
+        // Swap the catalog's root pointer
+        bool rooted = SetRootRRN(filename, newRootIndex);
         delete[] parentBuf; delete[] rootBuf;
-        return true;
+        return rooted;
     }
 
     // --- Normal Internal Split (Not Root) ---
@@ -188,6 +229,7 @@ bool insertIntoInternal(const char *filename, int parentRRN, int upKey, int upRe
 
     int idx = 1;
     for (size_t i = mid; i < entries.size(); i++) {
+        rightBuf[countSlot(idx)] = entries[i].count;
         rightBuf[idx++] = entries[i].key;
         rightBuf[idx++] = entries[i].reference;
     }
@@ -198,6 +240,7 @@ bool insertIntoInternal(const char *filename, int parentRRN, int upKey, int upRe
     parentBuf[0] = 1;
     idx = 1;
     for (int i = 0; i < mid; i++) {
+        parentBuf[countSlot(idx)] = entries[i].count;
         parentBuf[idx++] = entries[i].key;
         parentBuf[idx++] = entries[i].reference;
     }
@@ -212,76 +255,103 @@ bool insertIntoInternal(const char *filename, int parentRRN, int upKey, int upRe
 
     int grandparentRRN = path.back();
 
-    // Update key for Left Node in Grandparent
+    // Update key and count for Left Node in Grandparent
     int *gpBuf = new int[ROW_SIZE];
-    ReadNodeRaw(filename, grandparentRRN, gpBuf);
-    for (int i = 1; i < ROW_SIZE; i += 2) {
+    if (!ReadNodeRaw(filename, grandparentRRN, gpBuf)) { delete[] gpBuf; return false; }
+    for (int i = 1; i < ENTRY_FIELDS; i += 2) {
         if (gpBuf[i+1] == parentRRN) {
             gpBuf[i] = maxLeft;
+            gpBuf[countSlot(i)] = sumCounts(entries, 0, mid);
             break;
         }
     }
     WriteNodeRaw(filename, grandparentRRN, gpBuf);
     delete[] gpBuf;
 
-    return insertIntoInternal(filename, grandparentRRN, maxRight, rightNodeIndex, path);
+    return insertIntoInternal(filename, grandparentRRN, maxRight, rightNodeIndex,
+                              sumCounts(entries, mid, entries.size()), path);
+}
+
+// --- Subtree Count Update ---
+// Runs once the insert has finished: the ancestors above the node that absorbed the
+// new entry gain one key under the child they lead to. Split nodes and the absorbing
+// node already hold exact counts computed from their children.
+void applyInsertCounts(const char *filename, const vector<int> &path, const vector<int> &chosenSlots, int absorb) {
+    int buffer[ROW_SIZE];
+    for (int i = 0; i < absorb; i++) {
+        if (!ReadNodeRaw(filename, path[i], buffer)) return;
+        buffer[countSlot(chosenSlots[i])]++;
+        WriteNodeRaw(filename, path[i], buffer);
+    }
 }
 
 // --- Main Insert Function ---
 int InsertNewRecordAtIndex(const char *filename, int RecordID, int Reference) {
+    TraceScope trace(TRACE_INSERT, RecordID, Reference);
     int *buffer = new int[ROW_SIZE];
 
     // 1. Initialize Root
-    ReadNodeRaw(filename, 1, buffer);
-    if (buffer[0] == -1) {
-        int *header = new int[ROW_SIZE];
-        ReadNodeRaw(filename, 0, header);
-        header[1] = buffer[1];
-        WriteNodeRaw(filename, 0, header);
-        delete[] header;
+    int rootRRN = GetRootRRN(filename);
+    if (rootRRN == -1) {
+        rootRRN = GetFreeNode(filename);
+        if (rootRRN == -1) { delete[] buffer; return -1; } // Disk Full
 
         for (int k = 0; k < ROW_SIZE; k++) buffer[k] = -1;
         buffer[0] = 0; // Leaf
         buffer[1] = RecordID;
         buffer[2] = Reference;
-        WriteNodeRaw(filename, 1, buffer);
+        WriteNodeRaw(filename, rootRRN, buffer);
+        bool rooted = SetRootRRN(filename, rootRRN);
         delete[] buffer;
-        return 1;
+        return rooted ? rootRRN : -1;
     }
 
-    // 2. Traverse
-    int currentNode = 1;
+    // 2. Traverse; nothing is written until we know the insert can finish
+    int currentNode = rootRRN;
     vector<int> path;
+    vector<int> chosenSlots; // entry followed in each internal node of the path
+    vector<int> fill;        // entries in each node of the path
 
     while (true) {
-        ReadNodeRaw(filename, currentNode, buffer);
+        if (!ReadNodeRaw(filename, currentNode, buffer)) { delete[] buffer; return -1; }
         path.push_back(currentNode);
+        int used = 0;
+        for (int i = 1; i < ENTRY_FIELDS; i += 2) if (buffer[i] != -1) used++;
+        fill.push_back(used);
 
         if (buffer[0] == 0) break; // Leaf
 
-        bool found = false;
-        for (int i = 1; i < ROW_SIZE; i += 2) {
+        int chosen = -1;
+        for (int i = 1; i < ENTRY_FIELDS; i += 2) {
             if (buffer[i] != -1 && RecordID <= buffer[i]) {
-                currentNode = buffer[i + 1];
-                found = true;
+                chosen = i;
                 break;
             }
         }
-        if (!found) {
-            for (int i = ROW_SIZE - 2; i >= 1; i -= 2) {
+        if (chosen == -1) {
+            for (int i = ENTRY_FIELDS - 2; i >= 1; i -= 2) {
                 if (buffer[i] != -1) {
-                    currentNode = buffer[i + 1];
-                    found = true;
+                    chosen = i;
                     break;
                 }
             }
         }
-        if (!found) { delete[] buffer; return -1; }
+        if (chosen == -1) { delete[] buffer; return -1; }
+
+        chosenSlots.push_back(chosen);
+        currentNode = buffer[chosen + 1];
     }
 
+    // Splits climb from the leaf while nodes are full, each taking one free node
+    // (a root split takes one more); the node that absorbs the new entry is `absorb`
+    int absorb = (int)path.size() - 1;
+    while (absorb >= 0 && fill[absorb] >= M) absorb--;
+    int needed = (int)path.size() - 1 - absorb + (absorb < 0 ? 1 : 0);
+    if (needed > 0 && !HasFreeNodes(filename, needed)) { delete[] buffer; return -1; } // Disk Full
+
     // 3. Insert into Leaf
     vector<RecordEntry> entries;
-    for (int i = 1; i < ROW_SIZE; i += 2) {
+    for (int i = 1; i < ENTRY_FIELDS; i += 2) {
         if (buffer[i] != -1) {
             entries.push_back({buffer[i], buffer[i + 1]});
         }
@@ -301,6 +371,7 @@ int InsertNewRecordAtIndex(const char *filename, int RecordID, int Reference) {
         if (entries.back().key == RecordID) {
             propagateMaxKeyUpdate(filename, path, currentNode, RecordID);
         }
+        applyInsertCounts(filename, path, chosenSlots, absorb);
 
         delete[] buffer;
         return currentNode;
@@ -310,25 +381,22 @@ int InsertNewRecordAtIndex(const char *filename, int RecordID, int Reference) {
         int maxLeft = entries[mid - 1].key;
         int maxRight = entries.back().key;
 
-        // --- FIX: Check for Root Split FIRST ---
+        // --- Root Split: the old root keeps the left half, a new root goes on top ---
         if (path.size() == 1) { // Root is the only node in path
-            // Allocate Left (2) then Right (3)
-            int leftNodeIndex = GetFreeNode(filename);
             int rightNodeIndex = GetFreeNode(filename);
+            int newRootIndex = GetFreeNode(filename);
 
-            // Write Left Node (2)
-            int *leftBuf = new int[ROW_SIZE];
-            for(int k=0; k<ROW_SIZE; k++) leftBuf[k] = -1;
-            leftBuf[0] = 0; // Leaf
+            // Update Current (Left, still the old root RRN)
+            for (int k = 1; k < ROW_SIZE; k++) buffer[k] = -1;
+            buffer[0] = 0; // Leaf
             int idx = 1;
             for(int i=0; i<mid; i++) {
-                leftBuf[idx++] = entries[i].key;
-                leftBuf[idx++] = entries[i].reference;
+                buffer[idx++] = entries[i].key;
+                buffer[idx++] = entries[i].reference;
             }
-            WriteNodeRaw(filename, leftNodeIndex, leftBuf);
-            delete[] leftBuf;
+            WriteNodeRaw(filename, currentNode, buffer);
 
-            // Write Right Node (3)
+            // Write Right Node
             int *rightBuf = new int[ROW_SIZE];
             for(int k=0; k<ROW_SIZE; k++) rightBuf[k] = -1;
             rightBuf[0] = 0; // Leaf
@@ -340,17 +408,21 @@ int InsertNewRecordAtIndex(const char *filename, int RecordID, int Reference) {
             WriteNodeRaw(filename, rightNodeIndex, rightBuf);
             delete[] rightBuf;
 
-            // Update Root (1) -> Points to 2 then 3
+            // New Root points to Left then Right
             int *rootBuf = new int[ROW_SIZE];
             for(int k=0; k<ROW_SIZE; k++) rootBuf[k] = -1;
             rootBuf[0] = 1; // Internal
-            rootBuf[1] = maxLeft; rootBuf[2] = leftNodeIndex;
+            rootBuf[1] = maxLeft; rootBuf[2] = currentNode;
             rootBuf[3] = maxRight; rootBuf[4] = rightNodeIndex;
-            WriteNodeRaw(filename, 1, rootBuf);
+            rootBuf[countSlot(1)] = mid;
+            rootBuf[countSlot(3)] = (int)entries.size() - mid;
+            WriteNodeRaw(filename, newRootIndex, rootBuf);
             delete[] rootBuf;
 
+            // Swap the catalog's root pointer
+            bool rooted = SetRootRRN(filename, newRootIndex);
             delete[] buffer;
-            return 1;
+            return rooted ? newRootIndex : -1;
         }
 
         // --- Normal Split (Not Root) ---
@@ -381,21 +453,73 @@ int InsertNewRecordAtIndex(const char *filename, int RecordID, int Reference) {
         path.pop_back();
         int parentRRN = path.back();
 
-        // Update key for Left Child in Parent
+        // Update key and count for Left Child in Parent
         int *parentBuf = new int[ROW_SIZE];
-        ReadNodeRaw(filename, parentRRN, parentBuf);
-        for(int i=1; i<ROW_SIZE; i+=2) {
+        if (!ReadNodeRaw(filename, parentRRN, parentBuf)) {
+            delete[] parentBuf; delete[] buffer;
+            return -1;
+        }
+        for(int i=1; i<ENTRY_FIELDS; i+=2) {
             if(parentBuf[i+1] == currentNode) {
                 parentBuf[i] = maxLeft;
+                parentBuf[countSlot(i)] = mid;
                 WriteNodeRaw(filename, parentRRN, parentBuf);
                 break;
             }
         }
         delete[] parentBuf;
 
-        insertIntoInternal(filename, parentRRN, maxRight, rightNodeIndex, path);
+        insertIntoInternal(filename, parentRRN, maxRight, rightNodeIndex, (int)entries.size() - mid, path);
         delete[] rightBuf;
     }
+    applyInsertCounts(filename, path, chosenSlots, absorb);
     delete[] buffer;
     return currentNode;
-}
\ No newline at end of file
+}
+// --- In-place Reference Update ---
+// Keys, separators and counts do not change, so only the leaf row is rewritten.
+// Returns the leaf RRN, or -1 when the key is not in the index.
+int UpdateReference(const char *filename, int RecordID, int newReference) {
+    TraceScope trace(TRACE_UPDATE, RecordID, newReference);
+    fstream file(filename, ios::binary | ios::in | ios::out);
+    if (!file) return -1;
+
+    int buffer[ROW_SIZE];
+    int currentNode = GetRootRRN(file);
+    while (currentNode != -1) {
+        for (int k = 0; k < ROW_SIZE; k++) buffer[k] = -1;
+        if (!readRow(file, currentNode, buffer) || buffer[0] == -1) break;
+
+        if (buffer[0] == 0) {
+            for (int i = 1; i < ENTRY_FIELDS; i += 2) {
+                if (buffer[i] == RecordID) {
+                    buffer[i + 1] = newReference;
+                    writeRow(file, currentNode, buffer);
+                    file.close();
+                    return currentNode;
+                }
+            }
+            break;
+        }
+
+        int next = -1;
+        for (int i = 1; i < ENTRY_FIELDS; i += 2) {
+            if (buffer[i] != -1 && RecordID <= buffer[i]) {
+                next = buffer[i + 1];
+                break;
+            }
+        }
+        currentNode = next;
+    }
+
+    file.close();
+    return -1;
+}
+
+// --- Upsert ---
+// Overwrites the reference when the key exists, inserts it otherwise
+int Upsert(const char *filename, int RecordID, int Reference) {
+    int leaf = UpdateReference(filename, RecordID, Reference);
+    if (leaf != -1) return leaf;
+    return InsertNewRecordAtIndex(filename, RecordID, Reference);
+}
@@ -0,0 +1,411 @@
+/**
+ * this file has :
+ * an optional write-optimized tier in front of an index file
+ * 1- the memtable : a sorted in-memory map of the latest writes, with every
+ *    write first appended to a small write-ahead log (<index>.wal)
+ * 2- sorted runs : when the memtable is full it is written out sequentially
+ *    as an immutable run file (<index>.run.1, .run.2, ...) and the log is cleared
+ * 3- compaction : once enough runs pile up they are merged (newest wins) with
+ *    the B-tree in one ascending pass that feeds the packed builder of
+ *    Btree_Merge.cpp; the rebuilt file (<index>.compact) replaces the tree by
+ *    a rename. a file the builder cannot produce (direct or memory mode, or
+ *    other non-empty indexes in the same file) gets the ops in key order
+ *    instead, one leaf write per leaf for reference changes and the regular
+ *    insert and delete for new keys and tombstones
+ * 4- LsmOpen / LsmInsert / LsmDelete / LsmSearch / LsmFlush / LsmCompact
+ *
+ * lookups check the memtable, then the runs from newest to oldest, then the tree.
+ * deletes are tombstones until compaction removes the key from the tree.
+ * replaying the log or a run twice gives the same tree, so a crash at any point
+ * only repeats work on the next open.
+ *
+ * durability : LsmInsert / LsmDelete return true only once the log record is
+ * fsynced. a run file, and the tree after compaction, are fsynced (with their
+ * directory) before the log or the runs that hold the same writes are dropped.
+ * by default the write that fills the last run slot pays for the compaction;
+ * with compactOnFlush off the caller runs LsmCompact when it suits.
+ **/
+
+#include <fcntl.h>
+#include <unistd.h>
+
+struct LsmValue {
+    int32_t reference;
+    int32_t deleted;        // 1 = tombstone
+};
+
+struct LsmRun {
+    string path;
+    int32_t count;
+    int32_t minKey, maxKey; // fences: a run is skipped for keys outside them
+};
+
+struct LsmIndex {
+    string treeFile;
+    size_t memtableLimit = 4096;   // entries before the memtable becomes a run
+    size_t maxRuns = 4;            // runs before they are compacted into the tree
+    bool compactOnFlush = true;    // false: runs pile up until LsmCompact is called
+    map<int, LsmValue> memtable;
+    int wal = -1;                  // descriptor of the write-ahead log
+    off_t walBytes = 0;            // log size after the last whole record
+    vector<LsmRun> runs;           // oldest first
+    size_t nextRun = 1;            // sequence number of the next run file
+};
+
+const char lsmRunMagic[8] = {'B', 'T', 'R', 'U', 'N', '1', 0, 0};
+const int lsmRunHeader = sizeof(lsmRunMagic) + sizeof(int32_t);
+const int lsmRunRecord = 3 * sizeof(int32_t);  // key, reference, deleted
+const int lsmWalRecord = 1 + 2 * sizeof(int32_t);
+
+string lsmRunPath(const LsmIndex &lsm, size_t sequence) {
+    return lsm.treeFile + ".run." + to_string(sequence);
+}
+
+/// Directory holding the tree, its log and its runs
+string lsmDirectory(const string &treeFile) {
+    filesystem::path tree(treeFile);
+    return tree.has_parent_path() ? tree.parent_path().string() : string(".");
+}
+
+/// fsync a file or a directory by name; the streams that wrote it cannot
+bool syncPath(const string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+/// Sequence numbers of the run files on disk, ascending. Compaction removes the
+/// oldest runs first, so a crash can leave a gap at the front of the sequence.
+vector<size_t> findRunSequences(const LsmIndex &lsm) {
+    filesystem::path tree(lsm.treeFile);
+    filesystem::path dir = lsmDirectory(lsm.treeFile);
+    string prefix = tree.filename().string() + ".run.";
+
+    vector<size_t> sequences;
+    error_code ec;
+    for (const auto &entry : filesystem::directory_iterator(dir, ec)) {
+        string name = entry.path().filename().string();
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) continue;
+        string digits = name.substr(prefix.size());
+        if (digits.find_first_not_of("0123456789") != string::npos) continue;
+        sequences.push_back(stoull(digits));
+    }
+    sort(sequences.begin(), sequences.end());
+    return sequences;
+}
+
+/// ----------------- Sorted runs -----------------
+
+bool readRunRecord(istream &in, int index, int32_t &key, LsmValue &value) {
+    int32_t record[3];
+    in.seekg(lsmRunHeader + (streamoff)index * lsmRunRecord, ios::beg);
+    if (!in.read(reinterpret_cast<char*>(record), lsmRunRecord)) {
+        in.clear();
+        return false;
+    }
+    key = record[0];
+    value = {record[1], record[2]};
+    return true;
+}
+
+bool openRun(const string &path, LsmRun &run) {
+    ifstream in(path, ios::binary);
+    char magic[8];
+    if (!in || !in.read(magic, sizeof(magic)) || memcmp(magic, lsmRunMagic, sizeof(magic)) != 0) return false;
+    in.read(reinterpret_cast<char*>(&run.count), sizeof(run.count));
+    LsmValue unused;
+    run.path = path;
+    if (run.count == 0) return true;
+    return readRunRecord(in, 0, run.minKey, unused) && readRunRecord(in, run.count - 1, run.maxKey, unused);
+}
+
+/// Binary search one run; false if the run has nothing for the key
+bool searchRun(const LsmRun &run, int key, LsmValue &value) {
+    if (run.count == 0 || key < run.minKey || key > run.maxKey) return false;
+    ifstream in(run.path, ios::binary);
+    int lo = 0, hi = run.count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int32_t midKey;
+        if (!readRunRecord(in, mid, midKey, value)) return false;
+        if (midKey == key) return true;
+        if (midKey < key) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return false;
+}
+
+/// Stream every record of a run into `out`; later calls overwrite earlier ones
+void loadRun(const LsmRun &run, map<int, LsmValue> &out) {
+    ifstream in(run.path, ios::binary);
+    in.seekg(lsmRunHeader, ios::beg);
+    vector<int32_t> records((size_t)run.count * 3);
+    in.read(reinterpret_cast<char*>(records.data()), (streamsize)records.size() * sizeof(int32_t));
+    for (int i = 0; i < run.count; i++)
+        out[records[i*3]] = {records[i*3 + 1], records[i*3 + 2]};
+}
+
+/// ----------------- Write-ahead log -----------------
+
+/// (Re)open the log for appending; a torn record at its end is cut off so the
+/// next record starts on a record boundary
+bool openWal(LsmIndex &lsm, bool truncate) {
+    if (lsm.wal != -1) close(lsm.wal);
+    string path = lsm.treeFile + ".wal";
+    lsm.wal = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | (truncate ? O_TRUNC : 0), 0644);
+    if (lsm.wal == -1) return false;
+    off_t size = lseek(lsm.wal, 0, SEEK_END);
+    lsm.walBytes = size - size % lsmWalRecord;
+    return size == lsm.walBytes || ftruncate(lsm.wal, lsm.walBytes) == 0;
+}
+
+/// true once the record is on disk; a failed append is cut back off the log
+bool appendWal(LsmIndex &lsm, uint8_t deleted, int32_t key, int32_t reference) {
+    char record[lsmWalRecord];
+    record[0] = (char)deleted;
+    memcpy(record + 1, &key, 4);
+    memcpy(record + 5, &reference, 4);
+    if (lsm.wal == -1) return false;
+    if (write(lsm.wal, record, lsmWalRecord) != lsmWalRecord || fsync(lsm.wal) != 0) {
+        if (ftruncate(lsm.wal, lsm.walBytes) != 0) cerr << "Cannot repair write-ahead log\n";
+        return false;
+    }
+    lsm.walBytes += lsmWalRecord;
+    return true;
+}
+
+void replayWal(LsmIndex &lsm) {
+    ifstream in(lsm.treeFile + ".wal", ios::binary);
+    char record[lsmWalRecord];
+    while (in.read(record, lsmWalRecord)) {
+        int32_t key, reference;
+        memcpy(&key, record + 1, 4);
+        memcpy(&reference, record + 5, 4);
+        lsm.memtable[key] = {reference, record[0]};
+    }
+}
+
+/// ----------------- Applying to the tree -----------------
+
+// ops are sorted by key. One descent per leaf: references of keys already in
+// that leaf are changed in memory and the leaf is written once; new keys and
+// deletes still go through the regular insert and delete.
+void applyToTree(const char* treeFile, const vector<pair<int, LsmValue>> &ops) {
+    size_t i = 0;
+    while (i < ops.size()) {
+        vector<pair<int, LsmValue>> structural;
+        {
+            fstream file(treeFile, ios::in | ios::out | ios::binary);
+            vector<int> path, childIndices;
+            int leafRRN = findLeafForKey(file, ops[i].first, path, childIndices);
+            BTreeNode leaf = readNode(file, leafRRN);
+            int leafMax = leaf.status == LEAF_NODE ? maxKeyInNode(leaf) : -1;
+
+            bool changed = false;
+            size_t j = i;
+            do {
+                const pair<int, LsmValue> &op = ops[j];
+                int slot = -1;
+                for (int s = 0; s < M && leaf.status == LEAF_NODE; s++)
+                    if (leaf.keys[s] == op.first && leaf.refs[s] != -1) slot = s;
+
+                if (slot != -1 && !op.second.deleted) {
+                    if (leaf.refs[slot] != op.second.reference) {
+                        leaf.refs[slot] = op.second.reference;
+                        changed = true;
+                    }
+                } else if (slot != -1 || !op.second.deleted) {
+                    structural.push_back(op);
+                }
+                j++;
+            } while (j < ops.size() && ops[j].first <= leafMax);
+
+            if (changed) writeNode(file, leaf);
+            i = j;
+        }
+        for (const auto &op : structural) {
+            if (op.second.deleted) DeleteRecordFromIndex((char*)treeFile, op.first);
+            else InsertNewRecordAtIndex(treeFile, op.first, op.second.reference);
+        }
+    }
+}
+
+// One ascending pass: the old tree's cursor and the ops feed the packed builder,
+// an op replacing the tree's entry for its key and a tombstone dropping it. The
+// new file is fsynced and renamed over the tree; false leaves the tree untouched.
+bool rebuildWithOps(const char* treeFile, const vector<pair<int, LsmValue>> &ops) {
+    if (streamsBypassed()) return false;   // the builder writes through the streams
+
+    Superblock old;
+    {
+        ifstream in(treeFile, ios::binary);
+        if (!readSuperblock(in, old) || old.pageSize != rowBytes) return false;
+    }
+    // only the active index is rebuilt, so any other index must be empty
+    for (int i = 0; i < catalogCapacity; i++) {
+        const CatalogEntry &entry = old.catalog[i];
+        if (entry.name[0] != '\0' && activeIndex != entry.name && entry.root != -1) return false;
+    }
+
+    IndexCursor cursor;
+    if (!OpenCursor(cursor, treeFile)) return false;
+    // keep at least the room the file had, so the tree can still grow afterwards
+    int nodes = max(old.nodeCount, indexKeyCount(cursor.file) + (int)ops.size() + 2);
+    string temporary = string(treeFile) + ".compact";
+    CreateIndexFile(temporary.c_str(), nodes + 1);
+    fstream file(temporary, ios::in | ios::out | ios::binary);
+    if (!file) {
+        remove(temporary.c_str());
+        return false;
+    }
+
+    PackedBuilder builder(file);
+    bool more = First(cursor);
+    size_t i = 0;
+    while (more || i < ops.size()) {
+        if (i == ops.size() || (more && cursor.key() < ops[i].first)) {
+            builder.add(0, {cursor.key(), cursor.reference(), -1});
+            more = Next(cursor);
+            continue;
+        }
+        if (more && cursor.key() == ops[i].first) more = Next(cursor);
+        if (!ops[i].second.deleted) builder.add(0, {ops[i].first, ops[i].second.reference, -1});
+        i++;
+    }
+    int root = builder.finish();
+    cursor.file.close();
+
+    // same catalog as before; the generation carries on so the state never repeats
+    Superblock sb;
+    bool written = readSuperblock(file, sb);
+    sb.freeHead = builder.nextRRN <= sb.nodeCount ? builder.nextRRN : -1;
+    memcpy(sb.catalog, old.catalog, sizeof(sb.catalog));
+    sb.indexCount = old.indexCount;
+    sb.generation = max(sb.generation, old.generation + 1);
+    written = written && writeSuperblock(file, sb) && SetRootRRN(file, root);
+
+    file.close();
+    if (!written || !file || !syncPath(temporary) || rename(temporary.c_str(), treeFile) != 0) {
+        remove(temporary.c_str());
+        return false;
+    }
+    forgetSuperblock();   // the cache may still hold the file that was replaced
+    syncPath(lsmDirectory(treeFile));
+    return true;
+}
+
+/// ----------------- API -----------------
+
+bool LsmOpen(LsmIndex &lsm, const char* treeFile, size_t memtableLimit = 4096) {
+    lsm.treeFile = treeFile;
+    lsm.memtableLimit = memtableLimit;
+    lsm.memtable.clear();
+    lsm.runs.clear();
+
+    lsm.nextRun = 1;
+    for (size_t sequence : findRunSequences(lsm)) {
+        LsmRun run;
+        if (!openRun(lsmRunPath(lsm, sequence), run)) continue;
+        lsm.runs.push_back(run);
+        lsm.nextRun = sequence + 1;
+    }
+    replayWal(lsm);
+
+    if (!openWal(lsm, false)) {
+        cerr << "Cannot open write-ahead log\n";
+        return false;
+    }
+    return true;
+}
+
+/// Merge every run into the tree and remove them
+void LsmCompact(LsmIndex &lsm) {
+    map<int, LsmValue> merged;
+    for (const LsmRun &run : lsm.runs) loadRun(run, merged);   // oldest first, newest wins
+    vector<pair<int, LsmValue>> ops(merged.begin(), merged.end());
+    if (!ops.empty() && !rebuildWithOps(lsm.treeFile.c_str(), ops)) {
+        applyToTree(lsm.treeFile.c_str(), ops);
+        if (!streamsBypassed() && !syncPath(lsm.treeFile)) return;   // keep the runs
+    }
+
+    // oldest first: a crash part way leaves only newer runs, whose values the tree
+    // already holds, so they never shadow it with something stale
+    for (const LsmRun &run : lsm.runs) remove(run.path.c_str());
+    lsm.runs.clear();
+    lsm.nextRun = 1;
+}
+
+/// Write the memtable out as a new run and clear the log; false keeps both as they were
+bool LsmFlush(LsmIndex &lsm) {
+    if (lsm.memtable.empty()) return true;
+
+    LsmRun run;
+    run.path = lsmRunPath(lsm, lsm.nextRun++);
+    run.count = (int32_t)lsm.memtable.size();
+    run.minKey = lsm.memtable.begin()->first;
+    run.maxKey = lsm.memtable.rbegin()->first;
+
+    vector<int32_t> records;
+    records.reserve(lsm.memtable.size() * 3);
+    for (const auto &entry : lsm.memtable) {
+        records.push_back(entry.first);
+        records.push_back(entry.second.reference);
+        records.push_back(entry.second.deleted);
+    }
+    ofstream out(run.path, ios::binary | ios::trunc);
+    out.write(lsmRunMagic, sizeof(lsmRunMagic));
+    out.write(reinterpret_cast<const char*>(&run.count), sizeof(run.count));
+    out.write(reinterpret_cast<const char*>(records.data()), (streamsize)records.size() * sizeof(int32_t));
+    out.close();
+    // the log is only dropped once the run is known to be on disk
+    if (!out || !syncPath(run.path) || !syncPath(lsmDirectory(lsm.treeFile))) {
+        remove(run.path.c_str());
+        lsm.nextRun--;
+        return false;
+    }
+    lsm.runs.push_back(run);
+
+    lsm.memtable.clear();
+    if (!openWal(lsm, true)) cerr << "Cannot open write-ahead log\n";
+
+    if (lsm.compactOnFlush && lsm.runs.size() >= lsm.maxRuns) LsmCompact(lsm);
+    return true;
+}
+
+/// true once the write is durable in the log
+bool LsmInsert(LsmIndex &lsm, int key, int reference) {
+    if (!appendWal(lsm, 0, key, reference)) return false;
+    lsm.memtable[key] = {reference, 0};
+    if (lsm.memtable.size() >= lsm.memtableLimit) LsmFlush(lsm);
+    return true;
+}
+
+bool LsmDelete(LsmIndex &lsm, int key) {
+    if (!appendWal(lsm, 1, key, -1)) return false;
+    lsm.memtable[key] = {-1, 1};
+    if (lsm.memtable.size() >= lsm.memtableLimit) LsmFlush(lsm);
+    return true;
+}
+
+/// Reference for a key, -1 when it is missing or deleted
+int LsmSearch(LsmIndex &lsm, int key) {
+    auto it = lsm.memtable.find(key);
+    if (it != lsm.memtable.end()) return it->second.deleted ? -1 : it->second.reference;
+
+    LsmValue value;
+    for (size_t i = lsm.runs.size(); i-- > 0;) {
+        if (searchRun(lsm.runs[i], key, value)) return value.deleted ? -1 : value.reference;
+    }
+    return SearchARecord(lsm.treeFile.c_str(), key);
+}
+
+/// Push everything down into the tree (e.g. before closing)
+void LsmClose(LsmIndex &lsm) {
+    bool flushed = LsmFlush(lsm);
+    LsmCompact(lsm);
+    if (lsm.wal != -1) close(lsm.wal);
+    lsm.wal = -1;
+    if (flushed) remove((lsm.treeFile + ".wal").c_str());
+}
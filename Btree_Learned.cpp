@@ -0,0 +1,213 @@
+/**
+ * this file has :
+ * an optional learned model for read-mostly index files, kept next to the
+ * node format in a side file (<index>.learned)
+ * 1- piecewise linear segments mapping a key to its rank (position in key
+ *    order), each within `epsilon` of the true rank
+ * 2- the leaf directory : RRN, first rank and smallest key of every leaf, in
+ *    key order, so a predicted rank names a leaf without touching the tree
+ * 3- BuildLearnedIndex / SaveLearnedIndex / LoadLearnedIndex
+ * 4- int LearnedSearch (LearnedIndex&, int key) : one leaf read (two for a key
+ *    that falls between leaves) when the model can tell the answer for sure,
+ *    the normal descent (SearchARecord) otherwise
+ *
+ * the model is tied to the superblock it was built from. its CRC covers the
+ * superblock generation, so anything that allocates or frees a node, even a
+ * node freed and handed out again, makes the model fall back until it is
+ * rebuilt. inserts and deletes that stay inside one leaf leave the superblock
+ * alone, so a leaf is only trusted for keys between the smallest and largest
+ * keys it holds now, and a miss only when the neighbouring leaf confirms it
+ **/
+
+struct LearnedSegment {
+    int32_t firstKey;
+    int32_t firstRank;
+    double slope;
+};
+
+struct LearnedIndex {
+    string treeFile;
+    int epsilon = 4;
+    uint32_t superblockCrc = 0;     // superblock the model was built from
+    vector<LearnedSegment> segments;
+    vector<int32_t> leafRRN;        // leaves in key order
+    vector<int32_t> leafFirstRank;
+    vector<int32_t> leafMinKey;
+    int32_t keyCount = 0;
+    long long fallbacks = 0;        // lookups that needed the normal descent
+};
+
+const char learnedMagic[8] = {'B', 'T', 'L', 'E', 'A', 'R', 'N', '1'};
+
+/// ----------------- Building -----------------
+
+// greedy shrinking cone: a segment grows while one slope keeps every point
+// within epsilon of its rank
+struct SegmentFitter {
+    vector<LearnedSegment> &segments;
+    int epsilon;
+    bool open = false;
+    long long originKey = 0, originRank = 0;
+    double low = 0, high = 0;
+
+    SegmentFitter(vector<LearnedSegment> &s, int e) : segments(s), epsilon(e) {}
+
+    void close() {
+        if (!open) return;
+        double slope = isinf(high) ? low : (low + high) / 2;
+        segments.push_back({(int32_t)originKey, (int32_t)originRank, slope});
+        open = false;
+    }
+
+    void add(int key, int rank) {
+        if (open && key > originKey) {
+            double dx = (double)key - originKey;
+            double lo = (rank - epsilon - originRank) / dx;
+            double hi = (rank + epsilon - originRank) / dx;
+            if (max(low, lo) <= min(high, hi)) {
+                low = max(low, lo);
+                high = min(high, hi);
+                return;
+            }
+        }
+        close();
+        open = true;
+        originKey = key;
+        originRank = rank;
+        low = 0;
+        high = numeric_limits<double>::infinity();
+    }
+};
+
+bool BuildLearnedIndex(LearnedIndex &model, const char* treeFile, int epsilon = 4) {
+    model = LearnedIndex();
+    model.treeFile = treeFile;
+    model.epsilon = epsilon;
+
+    IndexCursor cursor;
+    if (!OpenCursor(cursor, treeFile)) return false;
+    Superblock sb;
+    if (!readSuperblock(cursor.file, sb)) return false;
+    model.superblockCrc = sb.crc;
+
+    SegmentFitter fitter(model.segments, epsilon);
+    int rank = 0;
+    for (bool ok = First(cursor); ok; ok = Next(cursor), rank++) {
+        int leaf = cursor.path.back().selfRRN;
+        if (model.leafRRN.empty() || model.leafRRN.back() != leaf) {
+            model.leafRRN.push_back(leaf);
+            model.leafFirstRank.push_back(rank);
+            model.leafMinKey.push_back(cursor.key());
+        }
+        fitter.add(cursor.key(), rank);
+    }
+    fitter.close();
+    model.keyCount = rank;
+    cursor.file.close();
+    return true;
+}
+
+/// ----------------- Side file -----------------
+
+template <typename T>
+void writeVector(ostream &out, const vector<T> &v) {
+    int32_t n = (int32_t)v.size();
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    out.write(reinterpret_cast<const char*>(v.data()), (streamsize)n * sizeof(T));
+}
+
+template <typename T>
+bool readVector(istream &in, vector<T> &v) {
+    int32_t n;
+    if (!in.read(reinterpret_cast<char*>(&n), sizeof(n)) || n < 0) return false;
+    v.resize(n);
+    return (bool)in.read(reinterpret_cast<char*>(v.data()), (streamsize)n * sizeof(T));
+}
+
+bool SaveLearnedIndex(const LearnedIndex &model) {
+    ofstream out(model.treeFile + ".learned", ios::binary | ios::trunc);
+    if (!out) return false;
+    out.write(learnedMagic, sizeof(learnedMagic));
+    out.write(reinterpret_cast<const char*>(&model.epsilon), sizeof(model.epsilon));
+    out.write(reinterpret_cast<const char*>(&model.superblockCrc), sizeof(model.superblockCrc));
+    out.write(reinterpret_cast<const char*>(&model.keyCount), sizeof(model.keyCount));
+    writeVector(out, model.segments);
+    writeVector(out, model.leafRRN);
+    writeVector(out, model.leafFirstRank);
+    writeVector(out, model.leafMinKey);
+    return (bool)out;
+}
+
+bool LoadLearnedIndex(LearnedIndex &model, const char* treeFile) {
+    model = LearnedIndex();
+    model.treeFile = treeFile;
+    ifstream in(model.treeFile + ".learned", ios::binary);
+    char magic[8];
+    if (!in || !in.read(magic, sizeof(magic)) || memcmp(magic, learnedMagic, sizeof(magic)) != 0) return false;
+    in.read(reinterpret_cast<char*>(&model.epsilon), sizeof(model.epsilon));
+    in.read(reinterpret_cast<char*>(&model.superblockCrc), sizeof(model.superblockCrc));
+    in.read(reinterpret_cast<char*>(&model.keyCount), sizeof(model.keyCount));
+    return readVector(in, model.segments) && readVector(in, model.leafRRN)
+        && readVector(in, model.leafFirstRank) && readVector(in, model.leafMinKey);
+}
+
+/// ----------------- Lookup -----------------
+
+/// Leaf position holding rank (the last leaf whose first rank <= rank)
+int leafOfRank(const LearnedIndex &model, long long rank) {
+    auto it = upper_bound(model.leafFirstRank.begin(), model.leafFirstRank.end(), rank);
+    return max(0, (int)(it - model.leafFirstRank.begin()) - 1);
+}
+
+int LearnedSearch(LearnedIndex &model, int key) {
+    // the superblock cache is dropped by every superblock write, so comparing
+    // against it costs no I/O until the tree changes
+    Superblock sb;
+    bool current = cachedSuperblock(model.treeFile.c_str(), sb) && sb.crc == model.superblockCrc;
+
+    if (current && !model.segments.empty()) {
+        fstream file;
+        if (!streamsBypassed()) file.open(model.treeFile, ios::in | ios::binary);
+
+        // predicted rank, then every leaf the rank can be in given the error bound
+        auto seg = upper_bound(model.segments.begin(), model.segments.end(), key,
+                               [](int k, const LearnedSegment &s) { return k < s.firstKey; });
+        if (seg != model.segments.begin()) --seg;
+        long long predicted = seg->firstRank + llround(seg->slope * ((double)key - seg->firstKey));
+        predicted = max(0LL, min<long long>(predicted, model.keyCount - 1));
+        int first = leafOfRank(model, predicted - model.epsilon);
+        int last = leafOfRank(model, predicted + model.epsilon);
+
+        // the candidate is the last leaf in the window starting at or below the key
+        int leaf = (int)(upper_bound(model.leafMinKey.begin() + first, model.leafMinKey.begin() + last + 1, key)
+                         - model.leafMinKey.begin()) - 1;
+        leaf = max(leaf, first);
+
+        // leaves never overlap, so a key between a leaf's smallest and largest keys
+        // can only be in that leaf. with the superblock unchanged no leaf was added
+        // or freed, so the directory order still holds and a key between two
+        // neighbouring leaves (or past either end) is a sure miss
+        BTreeNode node = readNode(file, model.leafRRN[leaf]);
+        int s = nextSlot(node, -1);
+        if (node.status == LEAF_NODE && s != -1) {
+            int result = -2;    // -2 = the leaf cannot tell
+            if (node.keys[s] <= key && key <= maxKeyInNode(node)) {
+                result = refInLeaf(node, key);
+            } else if (key < node.keys[s] && leaf == 0) {
+                result = -1;    // below the smallest key
+            } else if (key > maxKeyInNode(node)) {
+                if (leaf + 1 == (int)model.leafRRN.size()) {
+                    result = -1;    // above the largest key
+                } else {
+                    BTreeNode next = readNode(file, model.leafRRN[leaf + 1]);
+                    int t = nextSlot(next, -1);
+                    if (next.status == LEAF_NODE && t != -1 && key < next.keys[t]) result = -1;
+                }
+            }
+            if (result != -2) return result;
+        }
+    }
+
+    model.fallbacks++;
+    return SearchARecord(model.treeFile.c_str(), key);
+}
@@ -0,0 +1,103 @@
+/**
+ * this file has :
+ * 1- the in-memory backend : the whole index file is loaded with one
+ *    sequential read into a contiguous arena that holds the exact on-disk
+ *    image (superblock region, then the rows with their CRCs), so a node is
+ *    found by its RRN alone (rowOffset) and no pointers are kept anywhere
+ * 2- bool SnapshotIndex () : writes the arena back as IndexFile.bin in one
+ *    sequential write (to a temporary file first, then renamed over it)
+ * 3- snapshots on a timer : checked when an operation finishes, never in the
+ *    middle of one, so a snapshot always holds a consistent tree, and after
+ *    any write made outside an operation
+ *
+ * the mode is chosen when the file is opened (OpenIndex in BuildABtree.cpp);
+ * while it is open, all row and superblock I/O goes to the arena and the
+ * public API (InsertNewRecordAtIndex, DeleteRecordFromIndex, SearchARecord, ...)
+ * works unchanged; no node or superblock is read from or written to the file
+ * until a snapshot
+ **/
+
+struct MemoryIndex {
+    string path;                 // empty while the mode is off
+    vector<char> image;          // the file as it is on disk
+    bool dirty = false;          // changed since the last snapshot
+    double snapshotSeconds = 0;  // 0 = only on demand and on close
+    chrono::steady_clock::time_point lastSnapshot;
+
+    bool active() const { return !path.empty(); }
+};
+
+MemoryIndex memoryIndex;
+
+// index operations in progress (OperationScope in Btree_Trace.cpp); a timed
+// snapshot waits until this is back to 0
+int operationDepth = 0;
+
+void memorySnapshotIfDue();
+
+bool memoryRead(streamoff offset, void* out, size_t bytes) {
+    if (offset < 0 || (size_t)offset + bytes > memoryIndex.image.size()) return false;
+    memcpy(out, memoryIndex.image.data() + offset, bytes);
+    return true;
+}
+
+bool memoryWrite(streamoff offset, const void* in, size_t bytes) {
+    if (offset < 0 || (size_t)offset + bytes > memoryIndex.image.size()) return false;
+    memcpy(memoryIndex.image.data() + offset, in, bytes);
+    memoryIndex.dirty = true;
+    if (operationDepth == 0) memorySnapshotIfDue();
+    return true;
+}
+
+bool memoryOpen(const char* filename) {
+    ifstream in(filename, ios::binary | ios::ate);
+    if (!in) {
+        cerr << "Cannot open file\n";
+        return false;
+    }
+    streamsize size = in.tellg();
+    memoryIndex.image.resize((size_t)size);
+    in.seekg(0, ios::beg);
+    if (!in.read(memoryIndex.image.data(), size)) {
+        memoryIndex.image.clear();
+        return false;
+    }
+    memoryIndex.path = filename;
+    memoryIndex.dirty = false;
+    memoryIndex.lastSnapshot = chrono::steady_clock::now();
+    return true;
+}
+
+bool SnapshotIndex() {
+    if (!memoryIndex.active()) return false;
+    string temporary = memoryIndex.path + ".snapshot";
+    ofstream out(temporary, ios::binary | ios::trunc);
+    out.write(memoryIndex.image.data(), (streamsize)memoryIndex.image.size());
+    out.close();
+    if (!out || rename(temporary.c_str(), memoryIndex.path.c_str()) != 0) {
+        cerr << "Snapshot of " << memoryIndex.path << " failed\n";
+        return false;
+    }
+    memoryIndex.dirty = false;
+    memoryIndex.lastSnapshot = chrono::steady_clock::now();
+    return true;
+}
+
+/// Snapshot every `seconds` seconds while changes are pending; 0 turns the timer off
+void SetSnapshotInterval(double seconds) {
+    memoryIndex.snapshotSeconds = seconds;
+}
+
+// called between operations
+void memorySnapshotIfDue() {
+    if (!memoryIndex.active() || !memoryIndex.dirty || memoryIndex.snapshotSeconds <= 0) return;
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - memoryIndex.lastSnapshot;
+    if (elapsed.count() >= memoryIndex.snapshotSeconds) SnapshotIndex();
+}
+
+void memoryClose() {
+    if (!memoryIndex.active()) return;
+    if (memoryIndex.dirty) SnapshotIndex();
+    memoryIndex.path.clear();
+    vector<char>().swap(memoryIndex.image);
+}
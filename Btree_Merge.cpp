@@ -0,0 +1,185 @@
+/**
+ * this file has :
+ * 1- bool First (IndexCursor&) / bool Next (IndexCursor&) : ascending steps of
+ *    the cursor from Btree_ReverseScan.cpp, reading every node once per scan
+ * 2- the packed builder : takes keys in ascending order and writes full
+ *    nodes bottom-up at consecutive RRNs, one pending node per level
+ * 3- int MergeIndexes (Char* a, Char* b, Char* out, MergeConflict policy) :
+ *    merges the leaves of two index files in order and feeds the builder;
+ *    returns the number of keys in out, -1 on error. the output is built in
+ *    <out>.merge and renamed over out only once the merge has succeeded
+ **/
+
+enum MergeConflict {
+    KEEP_FIRST,        // a key in both files keeps the reference from a
+    KEEP_SECOND,       // a key in both files keeps the reference from b
+    FAIL_ON_CONFLICT   // a key in both files aborts the merge
+};
+
+/// ----------------- Ascending cursor steps -----------------
+
+/// First used slot after `after` (pass -1 for the first one), -1 if none
+int nextSlot(const BTreeNode& node, int after) {
+    for (int i = after + 1; i < M; i++)
+        if (node.keys[i] != -1 && node.refs[i] != -1) return i;
+    return -1;
+}
+
+// extend the path down the leftmost edge of the subtree at rrn
+bool pushLeftmost(IndexCursor& cursor, int rrn) {
+    while (rrn != -1) {
+        BTreeNode node = readNode(cursor.file, rrn);
+        int s = nextSlot(node, -1);
+        if (node.status == EMPTY_NODE || s == -1) break;
+        cursor.path.push_back(node);
+        cursor.slot.push_back(s);
+        if (node.status == LEAF_NODE) return cursor.valid = true;
+        rrn = node.refs[s];
+    }
+    return cursor.valid = false;
+}
+
+bool First(IndexCursor& cursor) {
+    cursor.path.clear();
+    cursor.slot.clear();
+    return pushLeftmost(cursor, GetRootRRN(cursor.file));
+}
+
+bool Next(IndexCursor& cursor) {
+    if (!cursor.valid) return false;
+    for (int level = (int)cursor.path.size() - 1; level >= 0; level--) {
+        int s = nextSlot(cursor.path[level], cursor.slot[level]);
+        if (s == -1) continue;
+
+        cursor.path.resize(level + 1);
+        cursor.slot.resize(level + 1);
+        cursor.slot[level] = s;
+        if (cursor.path[level].status == LEAF_NODE) return true;
+        return pushLeftmost(cursor, cursor.path[level].refs[s]);
+    }
+    return cursor.valid = false;
+}
+
+/// ----------------- Packed bottom-up builder -----------------
+
+struct PackedBuilder {
+    fstream &file;
+    int nextRRN = 1;                         // nodes are written at consecutive RRNs
+    vector<vector<NodeEntry>> levels;        // pending entries, level 0 = leaf entries
+
+    explicit PackedBuilder(fstream &f) : file(f) {}
+
+    // write one node from the front of a level and pass its entry up
+    void emit(size_t level, size_t take) {
+        vector<NodeEntry> &pending = levels[level];
+        BTreeNode node;
+        node.status = level == 0 ? LEAF_NODE : 1;
+        node.selfRRN = nextRRN++;
+        setNodeEntries(node, vector<NodeEntry>(pending.begin(), pending.begin() + take));
+        writeRow(file, node.selfRRN, nodeRow(node).data());
+        pending.erase(pending.begin(), pending.begin() + take);
+
+        if (levels.size() == level + 1) levels.emplace_back();
+        add(level + 1, {maxKeyInNode(node), node.selfRRN, subtreeKeyCount(node)});
+    }
+
+    // a full node is written only once two more entries are waiting behind it,
+    // so the last node of every level can never be left with fewer than two
+    void add(size_t level, const NodeEntry &entry) {
+        if (levels.size() <= level) levels.resize(level + 1);
+        levels[level].push_back(entry);
+        if ((int)levels[level].size() >= M + 2) emit(level, M);
+    }
+
+    /// Flush every level; returns the root RRN, -1 for an empty tree
+    int finish() {
+        // emitting adds to the level above, so the loop bound grows as it goes
+        for (size_t level = 0; level < levels.size(); level++) {
+            bool top = level + 1 == levels.size();
+            // the single entry left on the top level is the root itself
+            if (top && level > 0 && levels[level].size() == 1) return levels[level][0].ref;
+            if (levels[level].empty()) continue;
+            if ((int)levels[level].size() > M) emit(level, levels[level].size() / 2);
+            emit(level, levels[level].size());
+        }
+        return -1;
+    }
+
+    static vector<int> nodeRow(const BTreeNode &node) {
+        vector<int> row(rowSize, -1);
+        row[0] = node.status;
+        for (int i = 0; i < M; i++) {
+            row[1 + i*2] = node.keys[i];
+            row[2 + i*2] = node.refs[i];
+            row[countsOffset + i] = node.counts[i];
+        }
+        return row;
+    }
+};
+
+/// ----------------- Merge -----------------
+
+int indexKeyCount(fstream &file) {
+    int root = GetRootRRN(file);
+    return root == -1 ? 0 : subtreeKeyCount(readNode(file, root));
+}
+
+int MergeIndexes(const char* a, const char* b, const char* out, MergeConflict policy) {
+    IndexCursor first, second;
+    if (!OpenCursor(first, a) || !OpenCursor(second, b)) {
+        cout << "Cannot open input index\n";
+        return -1;
+    }
+
+    // packed nodes hold at least two entries, so n keys never need more than n nodes
+    int capacity = indexKeyCount(first.file) + indexKeyCount(second.file) + 2;
+    string temporary = string(out) + ".merge";
+    CreateIndexFile(temporary.c_str(), capacity + 1);
+    fstream file(temporary, ios::in | ios::out | ios::binary);
+    if (!file) {
+        cout << "Cannot create output index\n";
+        remove(temporary.c_str());
+        return -1;
+    }
+
+    PackedBuilder builder(file);
+    int merged = 0;
+    bool okA = First(first), okB = First(second);
+    while (okA || okB) {
+        NodeEntry entry;
+        if (okA && okB && first.key() == second.key()) {
+            if (policy == FAIL_ON_CONFLICT) {
+                cout << "Key " << first.key() << " is in both indexes\n";
+                file.close();
+                remove(temporary.c_str());
+                return -1;
+            }
+            entry = {first.key(), policy == KEEP_FIRST ? first.reference() : second.reference(), -1};
+            okA = Next(first);
+            okB = Next(second);
+        } else if (okA && (!okB || first.key() < second.key())) {
+            entry = {first.key(), first.reference(), -1};
+            okA = Next(first);
+        } else {
+            entry = {second.key(), second.reference(), -1};
+            okB = Next(second);
+        }
+        builder.add(0, entry);
+        merged++;
+    }
+    int root = builder.finish();
+
+    // rows after the last written node are still the free list CreateIndexFile linked up
+    Superblock sb;
+    bool written = readSuperblock(file, sb);
+    sb.freeHead = builder.nextRRN <= sb.nodeCount ? builder.nextRRN : -1;
+    written = written && writeSuperblock(file, sb) && SetRootRRN(file, root);
+
+    file.close();
+    if (!written || !file || rename(temporary.c_str(), out) != 0) {
+        cout << "Cannot create output index\n";
+        remove(temporary.c_str());
+        return -1;
+    }
+    return merged;
+}
@@ -0,0 +1,185 @@
+/**
+ * this file has :
+ * 1- vector<int> MultiGet (Char* filename, span<const int> keys) : batched
+ *    lookups, one coroutine per key, interleaved by a small scheduler
+ * 2- the awaitable node fetch : a node already read by the batch is used
+ *    directly; otherwise the fetch asks the kernel to start reading the row
+ *    and suspends, and the row is read when the lookup is resumed, after
+ *    the other lookups in the window had their turn
+ *
+ * 3- with C++17 (no coroutines) MultiGet takes a vector and serves the batch in
+ *    key order instead : every lookup reuses the nodes the previous key
+ *    descended through, so each node on the batch's paths is read once
+ *
+ * the coroutine version needs C++20 (-std=c++20)
+ **/
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#include <span>
+#include <fcntl.h>
+#include <unistd.h>
+
+/// lookups kept in flight at once; bounds the readahead requested from the kernel
+const int multiGetWindow = 32;
+
+/// ----------------- Lookup coroutine -----------------
+
+struct LookupTask {
+    struct promise_type {
+        int result = -1;
+
+        LookupTask get_return_object() {
+            return LookupTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(int value) { result = value; }
+        void unhandled_exception() { terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+
+    explicit LookupTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    LookupTask(LookupTask &&other) noexcept : handle(exchange(other.handle, nullptr)) {}
+    LookupTask &operator=(LookupTask &&other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    LookupTask(const LookupTask &) = delete;
+    ~LookupTask() { if (handle) handle.destroy(); }
+
+    bool done() const { return handle.done(); }
+    void resume() { handle.resume(); }
+    int result() const { return handle.promise().result; }
+};
+
+/// ----------------- Node fetches shared by the batch -----------------
+
+struct BatchNodeSource {
+    fstream file;
+    int fd = -1;                          // only used for readahead hints
+    unordered_map<int, BTreeNode> nodes;  // nodes already read by this batch
+
+    explicit BatchNodeSource(const char* filename)
+        : file(filename, ios::in | ios::binary) {
+        fd = open(filename, O_RDONLY);
+    }
+    ~BatchNodeSource() { if (fd != -1) close(fd); }
+
+    void prefetch(int rrn) {
+#ifdef POSIX_FADV_WILLNEED
+        if (fd != -1) posix_fadvise(fd, rowOffset(rrn), rowBytes, POSIX_FADV_WILLNEED);
+#endif
+    }
+
+    const BTreeNode &load(int rrn) {
+        auto it = nodes.find(rrn);
+        if (it != nodes.end()) return it->second;
+        return nodes.emplace(rrn, readNode(file, rrn)).first->second;
+    }
+};
+
+struct FetchNode {
+    BatchNodeSource &source;
+    int rrn;
+
+    // upper levels are shared by most keys of a batch, so they only miss once
+    bool await_ready() {
+        if (source.nodes.count(rrn)) return true;
+        source.prefetch(rrn);
+        return false;
+    }
+    // the scheduler resumes us after the other lookups in the window have run
+    void await_suspend(std::coroutine_handle<>) {}
+    BTreeNode await_resume() { return source.load(rrn); }
+};
+
+/// Same descent as SearchARecord, suspending at every node the batch has not read yet
+LookupTask lookupKey(BatchNodeSource &source, int rootRRN, int RecordID) {
+    int rrn = rootRRN;
+    while (rrn != -1) {
+        BTreeNode node = co_await FetchNode{source, rrn};
+        if (node.status == -1) break;
+        if (node.status == 0) co_return refInLeaf(node, RecordID);
+        rrn = childForKey(node, RecordID);
+    }
+    co_return -1;
+}
+
+/// ----------------- MultiGet -----------------
+
+/// Reference for every key (-1 when missing), in the order of keys
+vector<int> MultiGet(const char* filename, std::span<const int> keys) {
+    vector<int> refs(keys.size(), -1);
+    BatchNodeSource source(filename);
+    if (!source.file) return refs;
+
+    int rootRRN = GetRootRRN(source.file);
+    if (rootRRN == -1) return refs;
+
+    // round-robin over a window of lookups; a finished lookup frees its slot
+    vector<pair<size_t, LookupTask>> running;
+    size_t next = 0;
+    while (next < keys.size() || !running.empty()) {
+        while (next < keys.size() && (int)running.size() < multiGetWindow) {
+            running.emplace_back(next, lookupKey(source, rootRRN, keys[next]));
+            next++;
+        }
+        for (size_t i = 0; i < running.size();) {
+            running[i].second.resume();
+            if (running[i].second.done()) {
+                refs[running[i].first] = running[i].second.result();
+                swap(running[i], running.back());
+                running.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+
+    source.file.close();
+    return refs;
+}
+#else
+
+/// ----------------- MultiGet (C++17) -----------------
+
+/// Reference for every key (-1 when missing), in the order of keys
+vector<int> MultiGet(const char* filename, const vector<int> &keys) {
+    vector<int> refs(keys.size(), -1);
+    fstream file(filename, ios::in | ios::binary);
+    if (!file) return refs;
+
+    int rootRRN = GetRootRRN(file);
+    if (rootRRN == -1) return refs;
+
+    // sorted keys walk the leaves left to right, so consecutive lookups share
+    // their upper path; path[d] is the node last read at depth d
+    vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    vector<BTreeNode> path;
+    for (size_t i : order) {
+        int rrn = rootRRN;
+        for (size_t depth = 0; rrn != -1; depth++) {
+            if (depth == path.size()) path.emplace_back();
+            if (path[depth].selfRRN != rrn) path[depth] = readNode(file, rrn);
+            const BTreeNode &node = path[depth];
+            if (node.status == -1) break;
+            if (node.status == 0) {
+                refs[i] = refInLeaf(node, keys[i]);
+                break;
+            }
+            rrn = childForKey(node, keys[i]);
+        }
+    }
+
+    file.close();
+    return refs;
+}
+#endif
@@ -0,0 +1,99 @@
+/**
+ * this file has :
+ * order-statistic queries answered from the subtree key counts kept in
+ * internal entries, each one a single root-to-leaf descent (O(height)):
+ * 1- int Rank (Char* filename, int key) : how many keys are smaller than key
+ * 2- int CountRange (Char* filename, int lo, int hi) : how many keys are in [lo, hi]
+ * 3- int Select (Char* filename, int k) : the k-th smallest key (k starts at 1)
+ **/
+
+/// Count keys below `key` (or equal to it when inclusive is set) with one descent
+int countKeysBelow(fstream &file, int key, bool inclusive) {
+    int below = 0;
+    int current = GetRootRRN(file);
+
+    while (current != -1) {
+        BTreeNode node = readNode(file, current);
+        if (node.status == EMPTY_NODE) return below;
+
+        if (node.status == LEAF_NODE) {
+            for (int i = 0; i < M; i++) {
+                if (node.keys[i] == -1) continue;
+                if (node.keys[i] < key || (inclusive && node.keys[i] == key)) below++;
+            }
+            return below;
+        }
+
+        // keys are max values of subtrees: whole subtrees whose max is below the
+        // target are counted, and we descend into the first one that may hold it
+        int child = -1;
+        for (int i = 0; i < M; i++) {
+            if (node.keys[i] == -1 || node.refs[i] == -1) continue;
+            if (node.keys[i] < key || (inclusive && node.keys[i] == key)) {
+                below += node.counts[i];
+            } else {
+                child = node.refs[i];
+                break;
+            }
+        }
+        current = child;
+    }
+    return below;
+}
+
+/// ----------------- Rank -----------------
+int Rank(const char* filename, int key) {
+    fstream file(filename, ios::in | ios::binary);
+    if (!file) return -1;
+
+    int rank = countKeysBelow(file, key, false);
+    file.close();
+    return rank;
+}
+
+/// ----------------- Count keys in [lo, hi] -----------------
+int CountRange(const char* filename, int lo, int hi) {
+    if (lo > hi) return 0;
+    fstream file(filename, ios::in | ios::binary);
+    if (!file) return -1;
+
+    int count = countKeysBelow(file, hi, true) - countKeysBelow(file, lo, false);
+    file.close();
+    return count;
+}
+
+/// ----------------- Select the k-th smallest key -----------------
+int Select(const char* filename, int k) {
+    fstream file(filename, ios::in | ios::binary);
+    if (!file || k < 1) return -1;
+
+    int current = GetRootRRN(file);
+    while (current != -1) {
+        BTreeNode node = readNode(file, current);
+        if (node.status == EMPTY_NODE) break;
+
+        if (node.status == LEAF_NODE) {
+            // leaf keys are packed from slot 0
+            if (k <= countKeys(node)) {
+                file.close();
+                return node.keys[k - 1];
+            }
+            break;
+        }
+
+        // skip whole subtrees until the one holding the k-th key
+        int child = -1;
+        for (int i = 0; i < M; i++) {
+            if (node.refs[i] == -1) continue;
+            if (k <= node.counts[i]) {
+                child = node.refs[i];
+                break;
+            }
+            k -= node.counts[i];
+        }
+        current = child;
+    }
+
+    file.close();
+    return -1;
+}
@@ -0,0 +1,122 @@
+/**
+ * this file has :
+ * 1- void ReplayTrace (Char* traceFile, Char* indexFile, ReplayOptions) : runs
+ *    a recorded trace against an index file, at full speed or at the pacing
+ *    of the recording, and reports throughput and per-operation latency
+ * 2- int RunReplayCommand (argc, argv) : the "replay" command line tool
+ *
+ * usage: replay <trace> <index file> [--paced] [--fresh NODES]
+ *   without --fresh the trace runs against the file as it is (e.g. a copy of
+ *   a snapshot); with it the file is first recreated empty with NODES nodes
+ **/
+
+struct ReplayOptions {
+    bool paced = false;     // sleep so every operation starts at its recorded offset
+    int freshNodes = 0;     // > 0 : recreate the index file before replaying
+};
+
+/// ----------------- Report -----------------
+
+const char* traceOpName(uint8_t op) {
+    switch (op) {
+        case TRACE_INSERT: return "insert";
+        case TRACE_DELETE: return "delete";
+        case TRACE_SEARCH: return "search";
+        case TRACE_UPDATE: return "update";
+    }
+    return "unknown";
+}
+
+// latencies are in nanoseconds; sorts them in place
+void printLatencyLine(ostream &out, const char* name, vector<long long> &latencies) {
+    if (latencies.empty()) return;
+    sort(latencies.begin(), latencies.end());
+    long long total = 0;
+    for (long long l : latencies) total += l;
+    auto at = [&](double q) { return latencies[(size_t)(q * (latencies.size() - 1))] / 1000.0; };
+
+    out << fixed << setprecision(1)
+        << setw(8) << name << setw(10) << latencies.size()
+        << "  mean " << setw(9) << total / 1000.0 / latencies.size() << "us"
+        << "  p50 " << setw(9) << at(0.50) << "us"
+        << "  p99 " << setw(9) << at(0.99) << "us"
+        << "  max " << setw(9) << latencies.back() / 1000.0 << "us\n";
+}
+
+/// ----------------- Replay -----------------
+
+bool ReplayTrace(const char* traceFile, const char* indexFile, const ReplayOptions &opt) {
+    ifstream trace(traceFile, ios::binary);
+    char magic[8];
+    if (!trace || !trace.read(magic, sizeof(magic)) || memcmp(magic, traceMagic, sizeof(magic)) != 0) {
+        cout << "Not a trace file: " << traceFile << "\n";
+        return false;
+    }
+    if (opt.freshNodes > 0) CreateIndexFile((char*)indexFile, opt.freshNodes);
+
+    // the operations print progress messages; keep them out of the report
+    stringstream discard;
+    streambuf* saved = cout.rdbuf(discard.rdbuf());
+
+    map<uint8_t, vector<long long>> latencies;
+    vector<long long> all;
+    uint64_t offsetNs;
+    uint8_t op;
+    int32_t key, reference;
+    auto start = chrono::steady_clock::now();
+
+    while (readTraceRecord(trace, offsetNs, op, key, reference)) {
+        if (opt.paced) this_thread::sleep_until(start + chrono::nanoseconds(offsetNs));
+
+        auto begin = chrono::steady_clock::now();
+        switch (op) {
+            case TRACE_INSERT: InsertNewRecordAtIndex(indexFile, key, reference); break;
+            case TRACE_DELETE: DeleteRecordFromIndex((char*)indexFile, key); break;
+            case TRACE_SEARCH: SearchARecord(indexFile, key); break;
+            case TRACE_UPDATE: UpdateReference(indexFile, key, reference); break;
+            default: continue;
+        }
+        long long ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count();
+        latencies[op].push_back(ns);
+        all.push_back(ns);
+
+        // the messages are only thrown away; do not let them pile up
+        if (discard.tellp() > (1 << 20)) discard.str("");
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout.rdbuf(saved);
+
+    cout << "replayed " << all.size() << " operations in " << fixed << setprecision(3) << seconds << " s ("
+         << setprecision(0) << (seconds > 0 ? all.size() / seconds : 0) << " ops/s"
+         << (opt.paced ? ", paced" : "") << ")\n";
+    for (auto &entry : latencies) printLatencyLine(cout, traceOpName(entry.first), entry.second);
+    printLatencyLine(cout, "all", all);
+    if (checksumFailures) cout << "checksum failures: " << checksumFailures << "\n";
+    return true;
+}
+
+/// ----------------- Command line -----------------
+
+/// args are everything after "replay"; returns the process exit code
+int RunReplayCommand(int argc, char** argv) {
+    if (argc < 2) {
+        cout << "usage: replay <trace> <index file> [--paced] [--fresh NODES]\n";
+        return 1;
+    }
+
+    ReplayOptions opt;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--paced") {
+            opt.paced = true;
+        } else if (arg == "--fresh" && i + 1 < argc) {
+            opt.freshNodes = atoi(argv[++i]);
+        } else {
+            cout << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    return ReplayTrace(argv[0], argv[1], opt) ? 0 : 1;
+}
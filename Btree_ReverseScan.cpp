@@ -0,0 +1,138 @@
+/**
+ * this file has :
+ * descending iteration over the index. leaves have no sibling links, so a
+ * cursor keeps its root-to-leaf path (the node and the slot taken at every
+ * level); stepping back moves within the leaf and only climbs as far as the
+ * first level that still has an earlier entry, so a full reverse scan reads
+ * every node once instead of descending from the root per key
+ * 1- bool OpenCursor (IndexCursor&, Char* filename)
+ * 2- bool Last (IndexCursor&) : position on the largest key
+ * 3- bool SeekLE (IndexCursor&, int key) : position on the largest key <= key
+ * 4- bool Prev (IndexCursor&) : step to the next smaller key
+ * 5- int ScanReverse (Char* filename, int hi, int lo, callback) : visits the
+ *    keys in [lo, hi] from hi down; the callback returns false to stop early
+ **/
+
+struct IndexCursor {
+    fstream file;
+    vector<BTreeNode> path;   // root first, the current leaf last
+    vector<int> slot;         // slot taken in each node of the path
+    bool valid = false;
+
+    int key() const { return path.back().keys[slot.back()]; }
+    int reference() const { return path.back().refs[slot.back()]; }
+};
+
+/// Last used slot before `before` (pass M for the last one), -1 if none
+int prevSlot(const BTreeNode& node, int before) {
+    for (int i = before - 1; i >= 0; i--)
+        if (node.keys[i] != -1 && node.refs[i] != -1) return i;
+    return -1;
+}
+
+bool OpenCursor(IndexCursor& cursor, const char* filename) {
+    cursor.file.open(filename, ios::in | ios::binary);
+    cursor.path.clear();
+    cursor.slot.clear();
+    cursor.valid = false;
+    return (bool)cursor.file;
+}
+
+// extend the path down the rightmost edge of the subtree at rrn
+bool pushRightmost(IndexCursor& cursor, int rrn) {
+    while (rrn != -1) {
+        BTreeNode node = readNode(cursor.file, rrn);
+        int s = prevSlot(node, M);
+        if (node.status == EMPTY_NODE || s == -1) break;
+        cursor.path.push_back(node);
+        cursor.slot.push_back(s);
+        if (node.status == LEAF_NODE) return cursor.valid = true;
+        rrn = node.refs[s];
+    }
+    return cursor.valid = false;
+}
+
+bool Last(IndexCursor& cursor) {
+    cursor.path.clear();
+    cursor.slot.clear();
+    return pushRightmost(cursor, GetRootRRN(cursor.file));
+}
+
+bool Prev(IndexCursor& cursor) {
+    if (!cursor.valid) return false;
+
+    // climb to the deepest level that has an earlier entry, then take the
+    // rightmost path below it; the levels above are reused as they are
+    for (int level = (int)cursor.path.size() - 1; level >= 0; level--) {
+        int s = prevSlot(cursor.path[level], cursor.slot[level]);
+        if (s == -1) continue;
+
+        cursor.path.resize(level + 1);
+        cursor.slot.resize(level + 1);
+        cursor.slot[level] = s;
+        if (cursor.path[level].status == LEAF_NODE) return true;
+        return pushRightmost(cursor, cursor.path[level].refs[s]);
+    }
+    return cursor.valid = false;
+}
+
+bool SeekLE(IndexCursor& cursor, int key) {
+    cursor.path.clear();
+    cursor.slot.clear();
+    cursor.valid = false;
+
+    int rrn = GetRootRRN(cursor.file);
+    while (rrn != -1) {
+        BTreeNode node = readNode(cursor.file, rrn);
+        if (node.status == EMPTY_NODE) return false;
+
+        if (node.status == LEAF_NODE) {
+            int s = prevSlot(node, M);
+            while (s != -1 && node.keys[s] > key) s = prevSlot(node, s);
+            cursor.path.push_back(node);
+            cursor.valid = true;
+            if (s != -1) {
+                cursor.slot.push_back(s);
+                return true;
+            }
+            // every key here is larger: stand before the first one and step back
+            int first = M;
+            while (prevSlot(node, first) != -1) first = prevSlot(node, first);
+            cursor.slot.push_back(first);
+            return Prev(cursor);
+        }
+
+        // keys are max values of subtrees: the first child whose max >= key
+        int s = -1;
+        for (int i = 0; i < M; i++) {
+            if (node.keys[i] != -1 && node.refs[i] != -1 && key <= node.keys[i]) { s = i; break; }
+        }
+        if (s == -1) {
+            // key is above everything in this subtree
+            int last = prevSlot(node, M);
+            if (last == -1) return false;
+            cursor.path.push_back(node);
+            cursor.slot.push_back(last);
+            return pushRightmost(cursor, node.refs[last]);
+        }
+        cursor.path.push_back(node);
+        cursor.slot.push_back(s);
+        rrn = node.refs[s];
+    }
+    return false;
+}
+
+/// ----------------- Descending range scan -----------------
+/// Returns how many keys were passed to the callback
+int ScanReverse(const char* filename, int hi, int lo, const function<bool(int key, int reference)>& callback) {
+    IndexCursor cursor;
+    if (!OpenCursor(cursor, filename)) return -1;
+
+    int visited = 0;
+    for (bool ok = SeekLE(cursor, hi); ok && cursor.key() >= lo; ok = Prev(cursor)) {
+        visited++;
+        if (!callback(cursor.key(), cursor.reference())) break;
+    }
+    cursor.file.close();
+    return visited;
+}
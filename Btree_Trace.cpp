@@ -0,0 +1,75 @@
+/**
+ * this file has :
+ * 1- operation trace recording : when a trace is started, every insert,
+ *    delete, search and reference update made through the index API is
+ *    appended to a compact binary trace file with its time offset
+ * 2- void StartTrace (Char* filename) / void StopTrace ()
+ *
+ * trace file : magic "BTTRACE1", then one 17-byte record per operation :
+ * uint64 nanoseconds since the trace started, uint8 op, int32 key, int32 reference
+ **/
+
+enum TraceOp : uint8_t { TRACE_INSERT = 1, TRACE_DELETE = 2, TRACE_SEARCH = 3, TRACE_UPDATE = 4 };
+
+const char traceMagic[8] = {'B', 'T', 'T', 'R', 'A', 'C', 'E', '1'};
+const int traceRecordBytes = 17;
+
+ofstream traceOut;
+chrono::steady_clock::time_point traceStart;
+
+bool StartTrace(const char* filename) {
+    if (traceOut.is_open()) traceOut.close();
+    traceOut.open(filename, ios::binary | ios::trunc);
+    if (!traceOut) {
+        cout << "Cannot open trace file\n";
+        return false;
+    }
+    traceOut.write(traceMagic, sizeof(traceMagic));
+    traceStart = chrono::steady_clock::now();
+    return true;
+}
+
+void StopTrace() {
+    if (traceOut.is_open()) traceOut.close();
+}
+
+void writeTraceRecord(ostream &out, uint64_t offsetNs, uint8_t op, int32_t key, int32_t reference) {
+    char record[traceRecordBytes];
+    memcpy(record, &offsetNs, 8);
+    record[8] = (char)op;
+    memcpy(record + 9, &key, 4);
+    memcpy(record + 13, &reference, 4);
+    out.write(record, traceRecordBytes);
+}
+
+bool readTraceRecord(istream &in, uint64_t &offsetNs, uint8_t &op, int32_t &key, int32_t &reference) {
+    char record[traceRecordBytes];
+    if (!in.read(record, traceRecordBytes)) return false;
+    memcpy(&offsetNs, record, 8);
+    op = (uint8_t)record[8];
+    memcpy(&key, record + 9, 4);
+    memcpy(&reference, record + 13, 4);
+    return true;
+}
+
+/// Put at the top of an index operation that changes several nodes
+struct OperationScope {
+    OperationScope() { operationDepth++; }
+    // the outermost operation is done: the tree is consistent again, so a
+    // timed snapshot of the in-memory mode may run now
+    ~OperationScope() {
+        if (--operationDepth == 0) memorySnapshotIfDue();
+    }
+};
+
+/// Put at the top of a traced operation; records it when it is not nested in another one
+/// (the search done by a delete, the insert done by an upsert's fallback)
+struct TraceScope : OperationScope {
+    TraceScope(TraceOp op, int key, int reference = -1) {
+        if (operationDepth == 1 && traceOut.is_open()) {
+            uint64_t offset = chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - traceStart).count();
+            writeTraceRecord(traceOut, offset, op, key, reference);
+        }
+    }
+};
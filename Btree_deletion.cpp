@@ -5,30 +5,46 @@
  * Includes free-list helpers so leaf operations work standalone
  * int InsertNewRecordAtIndex (Char* filename, int RecordID, int Reference)
  * void DeleteRecordFromIndex (Char* filename, int RecordID)
+ * int DeleteRange (Char* filename, int lo, int hi)
  **/
 const int EMPTY_NODE = -1;
 const int LEAF_NODE = 0;
 
 /// ----------------- Free List Helpers -----------------
 
-// Return RRN to free list
-void releaseNodeToFreeList(fstream &file, int rrn) {
-    vector<int> row0(rowSize, -1);
-    file.seekg(0, ios::beg);
-    file.read(reinterpret_cast<char*>(row0.data()), rowSize * sizeof(int));
-    int firstFree = row0[1];
+// Return RRN to free list; false when the superblock could not be updated
+bool releaseNodeToFreeList(fstream &file, int rrn) {
+    Superblock sb;
+    if (!readSuperblock(file, sb)) return false;
+    int firstFree = sb.freeHead;
 
     vector<int> row(rowSize, -1);
     row[0] = EMPTY_NODE;
     row[1] = firstFree;
-    file.seekp(rrn * rowSize * sizeof(int), ios::beg);
-    file.write(reinterpret_cast<char*>(row.data()), rowSize * sizeof(int));
+    writeRow(file, rrn, row.data());
     file.flush();
 
-    row0[1] = rrn;
-    file.seekp(0, ios::beg);
-    file.write(reinterpret_cast<char*>(row0.data()), rowSize * sizeof(int));
+    sb.freeHead = rrn;
+    return writeSuperblock(file, sb);
+}
+
+// Return several RRNs at once: they are chained to each other in memory,
+// so the superblock is read and written once for the whole batch
+bool releaseNodesToFreeList(fstream &file, const vector<int> &rrns) {
+    if (rrns.empty()) return true;
+    Superblock sb;
+    if (!readSuperblock(file, sb)) return false;
+
+    vector<int> row(rowSize, -1);
+    row[0] = EMPTY_NODE;
+    for (size_t i = 0; i < rrns.size(); i++) {
+        row[1] = i + 1 < rrns.size() ? rrns[i + 1] : sb.freeHead;
+        writeRow(file, rrns[i], row.data());
+    }
     file.flush();
+
+    sb.freeHead = rrns.front();
+    return writeSuperblock(file, sb);
 }
 
 /// Helper: find maximum key in a node (rightmost non -1)
@@ -57,6 +73,16 @@ int countRefs(const BTreeNode& node) {
     return count;
 }
 
+// Helper: Count how many keys live in the subtree rooted at a node
+int subtreeKeyCount(const BTreeNode& node) {
+    if (node.status != 1) return countKeys(node);
+    int total = 0;
+    for (int i = 0; i < M; i++) {
+        if (node.refs[i] != -1) total += node.counts[i];
+    }
+    return total;
+}
+
 /// ----------------- Find position of child in parent -----------------
 int findChildPositionInParent(const BTreeNode& parent, int childRRN) {
     for(int i = 0; i < M; i++) {
@@ -69,7 +95,7 @@ int findChildPositionInParent(const BTreeNode& parent, int childRRN) {
 
 /// ----------------- Find leaf for key with path tracking -----------------
 int findLeafForKey(fstream &file, int key, vector<int> &path, vector<int> &childIndices) {
-    int current = 1; // root RRN
+    int current = GetRootRRN(file);
     path.clear();
     childIndices.clear();
     path.push_back(current);
@@ -151,25 +177,31 @@ bool borrowFromLeftSibling(fstream& file, BTreeNode& node, BTreeNode& parent, in
     // Get last key from left sibling
     int borrowedKey = leftSibling.keys[leftKeyCount-1];
     int borrowedRef = leftSibling.refs[leftKeyCount-1];
+    int borrowedCount = leftSibling.counts[leftKeyCount-1];
 
     // Shift node's keys right
     for(int i = nodeKeyCount; i > 0; i--) {
         node.keys[i] = node.keys[i-1];
         node.refs[i] = node.refs[i-1];
+        node.counts[i] = node.counts[i-1];
     }
 
     // Insert borrowed key at beginning
     node.keys[0] = borrowedKey;
     node.refs[0] = borrowedRef;
+    node.counts[0] = borrowedCount;
 
     // Remove from left sibling
     leftSibling.keys[leftKeyCount-1] = -1;
     leftSibling.refs[leftKeyCount-1] = -1;
+    leftSibling.counts[leftKeyCount-1] = -1;
 
     // Update parent separator (key between left sibling and node)
     if(nodePosInParent > 0) { // as the first node has no left sibbling
         parent.keys[nodePosInParent-1] = maxKeyInNode(leftSibling);
+        parent.counts[nodePosInParent-1] = subtreeKeyCount(leftSibling);
     }
+    parent.counts[nodePosInParent] = subtreeKeyCount(node);
 
     return true;
 }
@@ -184,22 +216,28 @@ bool borrowFromRightSibling(fstream& file, BTreeNode& node, BTreeNode& parent, i
     // Get first key from right sibling
     int borrowedKey = rightSibling.keys[0];
     int borrowedRef = rightSibling.refs[0];
+    int borrowedCount = rightSibling.counts[0];
 
     // Insert borrowed key at end of node
     node.keys[nodeKeyCount] = borrowedKey;
     node.refs[nodeKeyCount] = borrowedRef;
+    node.counts[nodeKeyCount] = borrowedCount;
 
     // Shift right sibling's keys left
     for(int i = 0; i < rightKeyCount-1; i++) {
         rightSibling.keys[i] = rightSibling.keys[i+1];
         rightSibling.refs[i] = rightSibling.refs[i+1];
+        rightSibling.counts[i] = rightSibling.counts[i+1];
     }
     rightSibling.keys[rightKeyCount-1] = -1;
     rightSibling.refs[rightKeyCount-1] = -1;
+    rightSibling.counts[rightKeyCount-1] = -1;
 
     // Update parent separator
     if(nodePosInParent < M-1) {
         parent.keys[nodePosInParent] = maxKeyInNode(node);
+        parent.counts[nodePosInParent] = subtreeKeyCount(node);
+        parent.counts[nodePosInParent+1] = subtreeKeyCount(rightSibling);
     }
 
     return true;
@@ -214,6 +252,7 @@ void mergeWithLeftSibling(fstream& file, BTreeNode& node, BTreeNode& parent, int
     for(int i = 0; i < nodeKeyCount; i++) {
         leftSibling.keys[leftKeyCount + i] = node.keys[i];
         leftSibling.refs[leftKeyCount + i] = node.refs[i];
+        leftSibling.counts[leftKeyCount + i] = node.counts[i];
     }
     // parent.keys[i] is the max key in subtree at parent.refs[i]
     // After merging node into leftSibling:
@@ -224,6 +263,7 @@ void mergeWithLeftSibling(fstream& file, BTreeNode& node, BTreeNode& parent, int
     // Update the key for leftSibling (now contains merged data)
     if(nodePosInParent > 0) {
         parent.keys[nodePosInParent-1] = maxKeyInNode(leftSibling);
+        parent.counts[nodePosInParent-1] = subtreeKeyCount(leftSibling);
     }
 
     // Remove key and reference for the merged node, then shift
@@ -232,11 +272,13 @@ void mergeWithLeftSibling(fstream& file, BTreeNode& node, BTreeNode& parent, int
     }
     parent.keys[M-1] = -1;
 
-    // Remove reference to merged node and shift
+    // Remove reference and count of merged node and shift
     for(int i = nodePosInParent; i < M-1; i++) {
         parent.refs[i] = parent.refs[i+1];
+        parent.counts[i] = parent.counts[i+1];
     }
     parent.refs[M-1] = -1;
+    parent.counts[M-1] = -1;
 
     // Free the node
     releaseNodeToFreeList(file, node.selfRRN);
@@ -251,6 +293,7 @@ void mergeWithRightSibling(fstream& file, BTreeNode& node, BTreeNode& parent, in
     for(int i = 0; i < rightKeyCount; i++) {
         node.keys[nodeKeyCount + i] = rightSibling.keys[i];
         node.refs[nodeKeyCount + i] = rightSibling.refs[i];
+        node.counts[nodeKeyCount + i] = rightSibling.counts[i];
     }
     // parent.keys[i] is the max key in subtree at parent.refs[i]
     // After merging rightSibling into node:
@@ -260,6 +303,7 @@ void mergeWithRightSibling(fstream& file, BTreeNode& node, BTreeNode& parent, in
 
     // Update the key for node (now contains merged data)
     parent.keys[nodePosInParent] = maxKeyInNode(node);
+    parent.counts[nodePosInParent] = subtreeKeyCount(node);
 
     // Remove key and reference for the right sibling, then shift
     for(int i = nodePosInParent+1; i < M-1; i++) {
@@ -267,40 +311,44 @@ void mergeWithRightSibling(fstream& file, BTreeNode& node, BTreeNode& parent, in
     }
     parent.keys[M-1] = -1;
 
-    // Remove reference to right sibling and shift
+    // Remove reference and count of right sibling and shift
     for(int i = nodePosInParent+1; i < M-1; i++) {
         parent.refs[i] = parent.refs[i+1];
+        parent.counts[i] = parent.counts[i+1];
     }
     parent.refs[M-1] = -1;
+    parent.counts[M-1] = -1;
 
     // Free the right sibling
     releaseNodeToFreeList(file, rightSibling.selfRRN);
 }
 
+/// ----------------- Collapse a root left with one child -----------------
+// The child becomes the root by swapping the catalog pointer; the old root is freed
+// false when the root was left as it is
+bool collapseRootIfSingleChild(fstream& file, const BTreeNode& root) {
+    if(root.status != 1 || countRefs(root) != 1) return false;
+
+    int childRRN = -1;
+    for(int i = 0; i < M; i++) {
+        if(root.refs[i] != -1) {
+            childRRN = root.refs[i];
+            break;
+        }
+    }
+    if(childRRN == -1) return false;
+
+    // the old root is only freed once nothing points at it any more
+    if(!SetRootRRN(file, childRRN)) return false;
+    releaseNodeToFreeList(file, root.selfRRN);
+    return true;
+}
+
 /// ----------------- Fix underflow -----------------
 void fixUnderflow(fstream& file, int nodeRRN, vector<int>& path, vector<int>& childIndices) {
-    if(nodeRRN == 1) {
+    if(nodeRRN == GetRootRRN(file)) {
         // Root can have any number of keys, but if it has only 1 child, promote that child
-        BTreeNode root = readNode(file, 1);
-        int childCount = countRefs(root);
-        if(childCount == 1) {
-            // Root has only 1 child - promote child to root
-            int childRRN = -1;
-            for(int i = 0; i < M; i++) {
-                if(root.refs[i] != -1) {
-                    childRRN = root.refs[i];
-                    break;
-                }
-            }
-            if(childRRN != -1) {
-                BTreeNode child = readNode(file, childRRN);
-                // Make child the new root
-                child.selfRRN = 1;
-                writeNode(file, child);
-                // Free the old child node (it's now at position 1)
-                releaseNodeToFreeList(file, childRRN);
-            }
-        }
+        collapseRootIfSingleChild(file, readNode(file, nodeRRN));
         return;
     }
 
@@ -342,9 +390,10 @@ void fixUnderflow(fstream& file, int nodeRRN, vector<int>& path, vector<int>& ch
 
         // Try to borrow
         if (borrowFromLeftSibling(file, node, parent, nodePosInParent, leftSibling)) {
-            // Write updated nodes
+            // Write updated nodes (parent carries the new separators and subtree counts)
             writeNode(file, node);
             writeNode(file, leftSibling);
+            writeNode(file, parent);
 
             // Update parent separator keys along the path
             updateParentSeparators(file, leftSibling.selfRRN, oldKey, path, childIndices);
@@ -363,9 +412,10 @@ void fixUnderflow(fstream& file, int nodeRRN, vector<int>& path, vector<int>& ch
 
         // Try to borrow
         if (borrowFromRightSibling(file, node, parent, nodePosInParent, rightSibling)) {
-            // Write updated nodes
+            // Write updated nodes (parent carries the new separators and subtree counts)
             writeNode(file, node);
             writeNode(file, rightSibling);
+            writeNode(file, parent);
 
             // Update parent separator keys along the path
             updateParentSeparators(file, node.selfRRN, oldKey, path, childIndices);
@@ -392,27 +442,9 @@ void fixUnderflow(fstream& file, int nodeRRN, vector<int>& path, vector<int>& ch
         writeNode(file, parent);
 
         // Check if parent is now underfull or if root has only 1 child
-        if(parentRRN == 1) {
+        if(parentRRN == GetRootRRN(file)) {
             // If root has only 1 child, promote that child to root
-            int childCount = countRefs(parent);
-            if(childCount == 1) {
-                // Find the single child
-                int childRRN = -1;
-                for(int i = 0; i < M; i++) {
-                    if(parent.refs[i] != -1) {
-                        childRRN = parent.refs[i];
-                        break;
-                    }
-                }
-                if(childRRN != -1) {
-                    BTreeNode child = readNode(file, childRRN);
-                    // Make child the new root
-                    child.selfRRN = 1;
-                    writeNode(file, child);
-                    // Free the old child node (it's now at position 1)
-                    releaseNodeToFreeList(file, childRRN);
-                }
-            }
+            collapseRootIfSingleChild(file, parent);
         } else if(countKeys(parent) < minKeys) {
             // Recursively fix parent (not root)
             path.pop_back(); // Remove current node from path
@@ -431,27 +463,9 @@ void fixUnderflow(fstream& file, int nodeRRN, vector<int>& path, vector<int>& ch
         writeNode(file, parent);
 
         // Check if root has only 1 child
-        if(parentRRN == 1) {
+        if(parentRRN == GetRootRRN(file)) {
             // If root has only 1 child, promote that child to root
-            int childCount = countRefs(parent);
-            if(childCount == 1) {
-                // Find the single child
-                int childRRN = -1;
-                for(int i = 0; i < M; i++) {
-                    if(parent.refs[i] != -1) {
-                        childRRN = parent.refs[i];
-                        break;
-                    }
-                }
-                if(childRRN != -1) {
-                    BTreeNode child = readNode(file, childRRN);
-                    // Make child the new root
-                    child.selfRRN = 1;
-                    writeNode(file, child);
-                    // Free the old child node (it's now at position 1)
-                    releaseNodeToFreeList(file, childRRN);
-                }
-            }
+            collapseRootIfSingleChild(file, parent);
         } else if(countKeys(parent) < minKeys) {
             // Recursively fix parent (not root)
             path.pop_back(); // Remove current node from path
@@ -463,6 +477,7 @@ void fixUnderflow(fstream& file, int nodeRRN, vector<int>& path, vector<int>& ch
 
 /// ----------------- Complete DeleteRecordFromIndex Function -----------------
 void DeleteRecordFromIndex(char* filename, int RecordID) {
+    TraceScope trace(TRACE_DELETE, RecordID);
     fstream file(filename, ios::in|ios::out|ios::binary);
     if(!file) {
         cout << "Cannot open file.\n";
@@ -484,7 +499,8 @@ void DeleteRecordFromIndex(char* filename, int RecordID) {
     int keyPos = -1;
     BTreeNode leaf;
 
-    int current = 1;
+    int rootRRN = GetRootRRN(file);
+    int current = rootRRN;
     bool found = false;
     while (true) {
         BTreeNode node = readNode(file, current);
@@ -584,6 +600,16 @@ void DeleteRecordFromIndex(char* filename, int RecordID) {
         return;
     }
 
+    // Every ancestor loses one key under the child we descended into
+    for (size_t level = 0; level + 1 < path.size(); level++) {
+        BTreeNode ancestor = readNode(file, path[level]);
+        int pos = findChildPositionInParent(ancestor, path[level + 1]);
+        if (pos != -1) {
+            ancestor.counts[pos]--;
+            writeNode(file, ancestor);
+        }
+    }
+
     // Phase 2: Delete from leaf
     int oldMax = maxKeyInNode(leaf); // Store max before deletion
 
@@ -607,7 +633,7 @@ void DeleteRecordFromIndex(char* filename, int RecordID) {
     // Phase 4: Check for underflow and fix it
     int minKeys = 2; // ceil(M/2)-1 for M=5
 
-    if(countKeys(leaf) < minKeys && leafRRN != 1) {
+    if(countKeys(leaf) < minKeys && leafRRN != rootRRN) {
         // Fix underflow
         fixUnderflow(file, leafRRN, path, childIndices);
 
@@ -683,3 +709,188 @@ void DeleteRecordFromIndex(char* filename, int RecordID) {
     cout << "Deletion process completed.\n";
 }
 
+
+/// ----------------- Delete a range of keys -----------------
+
+// one (key, ref, count) entry of a node; count is -1 in leaves
+struct NodeEntry {
+    int key;
+    int ref;
+    int count;
+};
+
+vector<NodeEntry> nodeEntries(const BTreeNode& node) {
+    vector<NodeEntry> entries;
+    for(int i = 0; i < M; i++) {
+        if(node.keys[i] != -1 && node.refs[i] != -1)
+            entries.push_back({node.keys[i], node.refs[i], node.status == 1 ? node.counts[i] : -1});
+    }
+    return entries;
+}
+
+void setNodeEntries(BTreeNode& node, const vector<NodeEntry>& entries) {
+    node.keys.assign(M, -1);
+    node.refs.assign(M, -1);
+    node.counts.assign(M, -1);
+    for(size_t i = 0; i < entries.size(); i++) {
+        node.keys[i] = entries[i].key;
+        node.refs[i] = entries[i].ref;
+        if(node.status == 1) node.counts[i] = entries[i].count;
+    }
+}
+
+// Collect a node and everything under it into `freed`. `height` is the number of
+// levels below the node, so only internal nodes are read; leaves are never read.
+void releaseSubtree(fstream& file, int rrn, int height, vector<int>& freed) {
+    if(height > 0) {
+        BTreeNode node = readNode(file, rrn);
+        for(int i = 0; i < M; i++)
+            if(node.refs[i] != -1) releaseSubtree(file, node.refs[i], height - 1, freed);
+    }
+    freed.push_back(rrn);
+}
+
+// Merge or rebalance every child of `node` left with fewer than minKeys entries.
+// Only `node` is changed in memory; the caller writes it.
+void repairChildren(fstream& file, BTreeNode& node) {
+    const int minKeys = 2;
+    vector<NodeEntry> entries = nodeEntries(node);
+
+    size_t i = 0;
+    while(i < entries.size()) {
+        BTreeNode child = readNode(file, entries[i].ref);
+        vector<NodeEntry> childEntries = nodeEntries(child);
+
+        if(childEntries.empty()) {
+            releaseNodeToFreeList(file, child.selfRRN);
+            entries.erase(entries.begin() + i);
+            continue;
+        }
+        if((int)childEntries.size() >= minKeys || entries.size() == 1) {
+            i++;
+            continue;
+        }
+
+        // pair the child with its right sibling, or its left one when it is the last child
+        size_t left = i + 1 < entries.size() ? i : i - 1;
+        BTreeNode leftNode = readNode(file, entries[left].ref);
+        BTreeNode rightNode = readNode(file, entries[left + 1].ref);
+        vector<NodeEntry> all = nodeEntries(leftNode);
+        vector<NodeEntry> rightEntries = nodeEntries(rightNode);
+        all.insert(all.end(), rightEntries.begin(), rightEntries.end());
+
+        if((int)all.size() <= M) {
+            // merge into the left node; its children may now have siblings to merge with
+            setNodeEntries(leftNode, all);
+            if(leftNode.status == 1) repairChildren(file, leftNode);
+            writeNode(file, leftNode);
+            releaseNodeToFreeList(file, rightNode.selfRRN);
+            entries[left] = {maxKeyInNode(leftNode), leftNode.selfRRN, subtreeKeyCount(leftNode)};
+            entries.erase(entries.begin() + left + 1);
+            i = left;
+        } else {
+            // enough entries for two nodes: split them evenly, then let an underfull
+            // grandchild merge with the siblings it gained
+            size_t half = all.size() / 2;
+            setNodeEntries(leftNode, vector<NodeEntry>(all.begin(), all.begin() + half));
+            setNodeEntries(rightNode, vector<NodeEntry>(all.begin() + half, all.end()));
+            if(leftNode.status == 1) {
+                repairChildren(file, leftNode);
+                repairChildren(file, rightNode);
+            }
+            writeNode(file, leftNode);
+            writeNode(file, rightNode);
+            entries[left] = {maxKeyInNode(leftNode), leftNode.selfRRN, subtreeKeyCount(leftNode)};
+            entries[left + 1] = {maxKeyInNode(rightNode), rightNode.selfRRN, subtreeKeyCount(rightNode)};
+            i = left;
+        }
+    }
+    setNodeEntries(node, entries);
+}
+
+// Remove the keys in [lo, hi] under `rrn`, whose keys are all >= low; `height` is the
+// number of levels below `rrn`. Children entirely inside the range go to `freed`
+// without their leaves being read. Returns how many keys were removed; the node is
+// written back, possibly underfull.
+int deleteRangeBelow(fstream& file, int rrn, int height, int lo, int hi, long long low, vector<int>& freed) {
+    BTreeNode node = readNode(file, rrn);
+    vector<NodeEntry> kept;
+    int removed = 0;
+
+    if(node.status == LEAF_NODE) {
+        for(const NodeEntry& e : nodeEntries(node)) {
+            if(e.key >= lo && e.key <= hi) removed++;
+            else kept.push_back(e);
+        }
+        setNodeEntries(node, kept);
+        writeNode(file, node);
+        return removed;
+    }
+
+    // child i holds the keys in [childLow, keys[i]]
+    long long childLow = low;
+    for(NodeEntry e : nodeEntries(node)) {
+        long long childHigh = e.key;
+        if(e.key < lo || childLow > hi) {
+            kept.push_back(e);
+        } else if(childLow >= lo && e.key <= hi) {
+            releaseSubtree(file, e.ref, height - 1, freed);
+            removed += e.count;
+        } else {
+            int gone = deleteRangeBelow(file, e.ref, height - 1, lo, hi, childLow, freed);
+            removed += gone;
+            e.count -= gone;
+            BTreeNode child = readNode(file, e.ref);
+            if(countRefs(child) == 0) {
+                releaseNodeToFreeList(file, e.ref);
+            } else {
+                e.key = maxKeyInNode(child);
+                kept.push_back(e);
+            }
+        }
+        childLow = childHigh + 1;
+    }
+
+    setNodeEntries(node, kept);
+    repairChildren(file, node);
+    writeNode(file, node);
+    return removed;
+}
+
+/// Remove every key in [lo, hi]; returns how many keys were removed
+int DeleteRange(const char* filename, int lo, int hi) {
+    OperationScope operation;
+    if(lo > hi) return 0;
+    fstream file(filename, ios::in | ios::out | ios::binary);
+    if(!file) {
+        cout << "Cannot open file.\n";
+        return -1;
+    }
+
+    int root = GetRootRRN(file);
+    if(root == -1) return 0;
+
+    // every leaf is at the same depth, so the leftmost path gives the height
+    int height = 0;
+    for(BTreeNode n = readNode(file, root); n.status == 1; n = readNode(file, n.refs[0])) height++;
+
+    vector<int> freed;
+    int removed = deleteRangeBelow(file, root, height, lo, hi, numeric_limits<long long>::min(), freed);
+    releaseNodesToFreeList(file, freed);
+
+    // shrink the root: an empty tree has no root, and a root with one child hands over to it
+    while(true) {
+        BTreeNode rootNode = readNode(file, root);
+        int entries = countRefs(rootNode);
+        if(entries == 0) {
+            if(SetRootRRN(file, -1)) releaseNodeToFreeList(file, root);
+            break;
+        }
+        if(rootNode.status != 1 || entries > 1) break;
+        if(!collapseRootIfSingleChild(file, rootNode)) break;
+        root = GetRootRRN(file);
+    }
+
+    file.close();
+    return removed;
+}
@@ -7,19 +7,334 @@
  * 4- int SearchARecord (Char* filename, int RecordID) implementation
  * 5- void CreateIndexFileFile (Char* filename, int numberOfRecords, int m) implementation
  * 6- void DisplayIndexFileContent (Char* filename) implementation
+ * 7- CRC32C page checksums (SSE4.2 with a software fallback)
+ * 8- sequential chunked row reads used by the display and dump tools
+ * 9- the superblock : format version, page size, free list head and a catalog
+ *    of named indexes, each with its own root RRN
+ * 10- bool OpenIndex (Char* filename, IndexIOMode mode, size_t cacheBytes) :
+ *    buffered I/O through the streams, direct I/O (Btree_DirectIO.cpp) or
+ *    the whole file in memory (Btree_Memory.cpp)
  **/
 
 #include <bits/stdc++.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#endif
 using namespace std;
 
-/// 5 keys, 5 references, 1 status
-const int rowSize = 11;
+#include "Btree_DirectIO.cpp"
+#include "Btree_Memory.cpp"
+#include "Btree_Trace.cpp"
+
+/// 1 status, 5 keys, 5 references, 5 subtree key counts
+const int rowSize = 16;
+/// status + (key, reference) pairs; the subtree counts start here
+const int countsOffset = 11;
+/// every row is stored followed by the CRC32C of its fields
+const int rowBytes = (rowSize + 1) * sizeof(int);
+
+/// the file starts with the superblock; node rows follow it and RRNs start at 1
+const int superblockBytes = 1024;
+
+/// Byte offset of a node row
+streamoff rowOffset(int rrn) {
+    return superblockBytes + (streamoff)(rrn - 1) * rowBytes;
+}
+
+/// ----------------- CRC32C (Castagnoli) -----------------
+// number of rows whose checksum did not match since the program started
+long long checksumFailures = 0;
+
+uint32_t crc32cSoftware(const unsigned char* data, size_t len) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+            table[i] = c;
+        }
+        tableReady = true;
+    }
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse4.2")))
+uint32_t crc32cHardware(const unsigned char* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len >= sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        data += sizeof(word);
+        len -= sizeof(word);
+    }
+    while (len--) crc = _mm_crc32_u8(crc, *data++);
+    return ~crc;
+}
+#endif
+
+/// CRC32C of a buffer, using the SSE4.2 crc32 instruction when the CPU has it
+uint32_t crc32c(const void* data, size_t len) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+#if defined(__x86_64__) || defined(__i386__)
+    static const bool hasSse42 = __builtin_cpu_supports("sse4.2");
+    if (hasSse42) return crc32cHardware(bytes, len);
+#endif
+    return crc32cSoftware(bytes, len);
+}
+
+/// Write one row (rowSize ints) and its checksum at the given RRN.
+/// Returns false if there is no node at that RRN or the write failed.
+bool writeRow(ostream &out, int rrn, const int* row) {
+    int stored[rowSize + 1];
+    memcpy(stored, row, rowSize * sizeof(int));
+    uint32_t crc = crc32c(row, rowSize * sizeof(int));
+    memcpy(&stored[rowSize], &crc, sizeof(crc));
+
+    if (rrn < 1) return false; // no node there (e.g. a failed allocation), never touch the superblock
+    if (directIndex.active()) return directWrite(rrn, stored, rowBytes);
+    if (memoryIndex.active()) return memoryWrite(rowOffset(rrn), stored, rowBytes);
+    out.seekp(rowOffset(rrn), ios::beg);
+    out.write(reinterpret_cast<char*>(stored), rowBytes);
+    return bool(out);
+}
+
+/// Read one row (rowSize ints) at the given RRN and verify its checksum.
+/// Returns false if the row could not be read or is corrupted.
+bool readRow(istream &in, int rrn, int* row) {
+    int stored[rowSize + 1];
+    if (rrn < 1) return false;
+    if (directIndex.active()) {
+        // the page was verified when it was loaded (verifyRowPage), so a cache hit skips the CRC
+        return directRead(rrn, row, rowSize * sizeof(int));
+    }
+    if (memoryIndex.active()) {
+        if (!memoryRead(rowOffset(rrn), stored, rowBytes)) return false;
+    } else {
+        in.seekg(rowOffset(rrn), ios::beg);
+        if (!in.read(reinterpret_cast<char*>(stored), rowBytes)) {
+            in.clear();
+            return false;
+        }
+    }
+
+    // verify before handing anything back, so a corrupted row never reaches the caller's buffer
+    uint32_t crc;
+    memcpy(&crc, &stored[rowSize], sizeof(crc));
+    if (crc != crc32c(stored, rowSize * sizeof(int))) {
+        checksumFailures++;
+        cerr << "Checksum mismatch in node " << rrn << "\n";
+        return false;
+    }
+    memcpy(row, stored, rowSize * sizeof(int));
+    return true;
+}
+
+/// Direct I/O load check (Btree_DirectIO.cpp) : the row at the start of a node page
+/// must match its CRC; page 0 is the superblock, which readSuperblock checks itself
+bool verifyRowPage(int page, const char* data) {
+    if (page == 0) return true;
+    uint32_t crc;
+    memcpy(&crc, data + rowSize * sizeof(int), sizeof(crc));
+    if (crc == crc32c(data, rowSize * sizeof(int))) return true;
+    checksumFailures++;
+    cerr << "Checksum mismatch in node " << page << "\n";
+    return false;
+}
+
+/// ----------------- Superblock -----------------
+const int formatVersion = 3;
+const int catalogCapacity = 16;
+const int indexNameSize = 32;
+
+struct CatalogEntry {
+    char name[indexNameSize];   // empty name = unused slot
+    int32_t root;               // RRN of the root node, -1 while the index is empty
+};
+
+struct Superblock {
+    char magic[8];              // "BTREEIX"
+    int32_t version;
+    int32_t pageSize;           // bytes per node row on disk
+    int32_t nodeCount;          // node rows in the file (RRN 1 .. nodeCount)
+    int32_t freeHead;           // first free node shared by every index, -1 when full
+    int32_t indexCount;
+    CatalogEntry catalog[catalogCapacity];
+    uint32_t generation;        // bumped by every superblock write, so a state never repeats
+    uint32_t crc;
+};
+static_assert(sizeof(Superblock) <= superblockBytes, "superblock does not fit its region");
+
+/// the index the int API (InsertNewRecordAtIndex, SearchARecord, ...) works on
+string activeIndex = "default";
+
+void UseIndex(const char* name) {
+    activeIndex = name;
+}
+
+/// The last superblock seen through the filename helpers (GetRootRRN, SetRootRRN,
+/// GetFreeNode), so they do not reopen the file just to reread it. Every
+/// writeSuperblock drops it, since the stream overloads do not know their file,
+/// and so does CreateIndexFile, which lays the superblock down itself.
+struct SuperblockCache {
+    string filename;
+    Superblock sb;
+    bool valid = false;
+} superblockCache;
+
+void forgetSuperblock() {
+    superblockCache.valid = false;
+}
+
+void rememberSuperblock(const char* filename, const Superblock &sb) {
+    superblockCache.filename = filename;
+    superblockCache.sb = sb;
+    superblockCache.valid = true;
+}
+
+/// Returns false when the superblock did not reach the file (or the direct/memory image)
+bool writeSuperblock(ostream &out, Superblock &sb) {
+    forgetSuperblock();
+    sb.generation++;
+    sb.crc = crc32c(&sb, offsetof(Superblock, crc));
+    if (directIndex.active()) return directWrite(0, &sb, sizeof(sb));
+    if (memoryIndex.active()) return memoryWrite(0, &sb, sizeof(sb));
+    out.seekp(0, ios::beg);
+    out.write(reinterpret_cast<char*>(&sb), sizeof(sb));
+    out.flush();
+    return !out.fail();
+}
+
+bool readSuperblock(istream &in, Superblock &sb) {
+    memset(&sb, 0, sizeof(sb));
+    if (directIndex.active()) {
+        if (!directRead(0, &sb, sizeof(sb))) return false;
+    } else if (memoryIndex.active()) {
+        if (!memoryRead(0, &sb, sizeof(sb))) return false;
+    } else {
+        in.seekg(0, ios::beg);
+        if (!in.read(reinterpret_cast<char*>(&sb), sizeof(sb))) {
+            in.clear();
+            return false;
+        }
+    }
+    if (memcmp(sb.magic, "BTREEIX", 8) != 0 || sb.version != formatVersion) {
+        cerr << "Unsupported index file format\n";
+        return false;
+    }
+    if (sb.crc != crc32c(&sb, offsetof(Superblock, crc))) {
+        checksumFailures++;
+        cerr << "Checksum mismatch in superblock\n";
+        return false;
+    }
+    return true;
+}
+
+/// Catalog slot of a named index, -1 if the file has no index with that name
+int findCatalogEntry(const Superblock &sb, const string &name) {
+    for (int i = 0; i < catalogCapacity; i++) {
+        if (sb.catalog[i].name[0] != '\0' && name == sb.catalog[i].name) return i;
+    }
+    return -1;
+}
+
+/// Add an empty index to the catalog; returns its slot or -1 if the catalog is full
+int addCatalogEntry(Superblock &sb, const string &name) {
+    int slot = findCatalogEntry(sb, name);
+    if (slot != -1) return slot;
+    for (int i = 0; i < catalogCapacity; i++) {
+        if (sb.catalog[i].name[0] == '\0') {
+            memset(sb.catalog[i].name, 0, indexNameSize);
+            strncpy(sb.catalog[i].name, name.c_str(), indexNameSize - 1);
+            sb.catalog[i].root = -1;
+            sb.indexCount++;
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// Root RRN of the active index, -1 if it is empty or missing
+int GetRootRRN(istream &in) {
+    Superblock sb;
+    if (!readSuperblock(in, sb)) return -1;
+    int slot = findCatalogEntry(sb, activeIndex);
+    return slot == -1 ? -1 : sb.catalog[slot].root;
+}
+
+/// Point the active index at a new root; this single write is the whole root change.
+/// Returns false when the root was not changed.
+bool SetRootRRN(fstream &file, int rrn) {
+    Superblock sb;
+    if (!readSuperblock(file, sb)) return false;
+    int slot = addCatalogEntry(sb, activeIndex);
+    if (slot == -1) {
+        cerr << "Index catalog is full\n";
+        return false;
+    }
+    sb.catalog[slot].root = rrn;
+    return writeSuperblock(file, sb);
+}
+
+/// Superblock of `filename`, from the cache when nothing has rewritten it since
+bool cachedSuperblock(const char* filename, Superblock &sb) {
+    if (superblockCache.valid && superblockCache.filename == filename) {
+        sb = superblockCache.sb;
+        return true;
+    }
+    ifstream file(filename, ios::binary);
+    if (!readSuperblock(file, sb)) return false;
+    rememberSuperblock(filename, sb);
+    return true;
+}
+
+int GetRootRRN(const char* filename) {
+    Superblock sb;
+    if (!cachedSuperblock(filename, sb)) return -1;
+    int slot = findCatalogEntry(sb, activeIndex);
+    return slot == -1 ? -1 : sb.catalog[slot].root;
+}
+
+bool SetRootRRN(const char* filename, int rrn) {
+    Superblock sb;
+    if (!cachedSuperblock(filename, sb)) return false;
+    int slot = addCatalogEntry(sb, activeIndex);
+    if (slot == -1) {
+        cerr << "Index catalog is full\n";
+        return false;
+    }
+    sb.catalog[slot].root = rrn;
+    fstream file(filename, ios::in | ios::out | ios::binary);
+    if (!writeSuperblock(file, sb)) return false;
+    rememberSuperblock(filename, sb);
+    return true;
+}
+
+/// Register another named index in an existing file
+bool CreateIndexInFile(const char* filename, const char* name) {
+    fstream file(filename, ios::in | ios::out | ios::binary);
+    Superblock sb;
+    if (!file || !readSuperblock(file, sb)) return false;
+    if (addCatalogEntry(sb, name) == -1) {
+        cerr << "Index catalog is full\n";
+        return false;
+    }
+    return writeSuperblock(file, sb);
+}
 
 /// BTreeNode structure
 struct BTreeNode {
     int status;           // -1 empty, 0 leaf, 1 internal
     vector<int> keys;     // 5 keys
     vector<int> refs;     // 5 references
+    vector<int> counts;   // keys under each child (internal nodes only)
     int selfRRN;          // in-memory RRN
 
     BTreeNode() {
@@ -27,31 +342,144 @@ struct BTreeNode {
         selfRRN = -1;
         keys.assign(5, -1);
         refs.assign(5, -1);
+        counts.assign(5, -1);
     }
 };
 
 /// Create empty index file with free list
-void CreateIndexFile(const char* filename, int numberOfNodes) {
+enum IndexIOMode { BUFFERED_IO, DIRECT_IO, MEMORY_IO };
+
+/// the paged layout used by direct I/O : the superblock in page 0, RRN r alone in page r
+void createPagedIndexFile(ofstream &file, Superblock &sb, int numberOfNodes) {
+    sb.pageSize = directPageSize;
+    sb.crc = crc32c(&sb, offsetof(Superblock, crc));
+    vector<char> page(directPageSize, 0);
+    memcpy(page.data(), &sb, sizeof(sb));
+    file.write(page.data(), directPageSize);
+
+    int stored[rowSize + 1];
+    for (int i = 1; i < numberOfNodes; i++) {
+        for (int k = 0; k < rowSize; k++) stored[k] = -1;
+        stored[1] = (i + 1 < numberOfNodes) ? i + 1 : -1;
+        uint32_t crc = crc32c(stored, rowSize * sizeof(int));
+        memcpy(&stored[rowSize], &crc, sizeof(crc));
+        fill(page.begin(), page.end(), 0);
+        memcpy(page.data(), stored, rowBytes);
+        file.write(page.data(), directPageSize);
+    }
+}
+
+void CreateIndexFile(const char* filename, int numberOfNodes, IndexIOMode mode = BUFFERED_IO) {
+    forgetSuperblock();   // the file is replaced, whichever layout writes its superblock
     ofstream file(filename, ios::binary | ios::trunc);
 
-    vector<int> row(rowSize, -1);
+    // Superblock -> first free node = 1, one empty index named "default"
+    Superblock sb;
+    memset(&sb, 0, sizeof(sb));
+    memcpy(sb.magic, "BTREEIX", 8);
+    sb.version = formatVersion;
+    sb.pageSize = rowBytes;
+    sb.nodeCount = numberOfNodes - 1;
+    sb.freeHead = numberOfNodes > 1 ? 1 : -1;
+    addCatalogEntry(sb, "default");
+    if (mode == DIRECT_IO) {
+        createPagedIndexFile(file, sb, numberOfNodes);
+        file.close();
+        return;
+    }
+    vector<char> region(superblockBytes, 0);
+    file.write(region.data(), superblockBytes);
+    if (!writeSuperblock(file, sb)) {
+        cerr << "Cannot create " << filename << "\n";
+        return;
+    }
 
-    // Node 0 -> first free node = 1
-    row[0] = -1;
-    row[1] = 1;
-    file.write(reinterpret_cast<char*>(row.data()), rowSize * sizeof(int));
+    vector<int> row(rowSize, -1);
 
     // Nodes from 1 to numberOfNodes-1 are being initialized as empty, linked list of free nodes
     for (int i = 1; i < numberOfNodes; i++) {
         row.assign(rowSize, -1);
         row[0] = -1;
         row[1] = (i + 1 < numberOfNodes) ? i + 1 : -1; // last node points to -1
-        file.write(reinterpret_cast<char*>(row.data()), rowSize * sizeof(int));
+        writeRow(file, i, row.data());
     }
 
     file.close();
 }
 
+/// True while row and superblock I/O bypasses the streams (direct or memory mode)
+bool streamsBypassed() {
+    return directIndex.active() || memoryIndex.active();
+}
+
+/// Leaves direct or memory mode; memory mode writes a last snapshot if anything changed
+void CloseIndex() {
+    directClose();
+    memoryClose();
+    forgetSuperblock();
+}
+
+/// Choose how the index file is accessed until the next OpenIndex/CloseIndex.
+/// Direct I/O needs a file created with DIRECT_IO and keeps at most cacheBytes of nodes
+/// in memory; memory mode loads the whole (buffered layout) file and ignores cacheBytes.
+/// Only one file can be open in direct or memory mode at a time.
+bool OpenIndex(const char* filename, IndexIOMode mode, size_t cacheBytes = 1 << 20) {
+    CloseIndex();
+    if (mode == DIRECT_IO && !directOpen(filename, cacheBytes, verifyRowPage)) return false;
+    if (mode == MEMORY_IO && !memoryOpen(filename)) return false;
+
+    ifstream file(filename, ios::binary);
+    Superblock sb;
+    if (!readSuperblock(file, sb)) {
+        CloseIndex();
+        return false;
+    }
+    int expected = mode == DIRECT_IO ? directPageSize : rowBytes;
+    if (sb.pageSize != expected) {
+        cerr << "Index file layout does not match the I/O mode\n";
+        CloseIndex();
+        return false;
+    }
+    return true;
+}
+
+/// Read up to maxRows consecutive rows starting at firstRRN with one sequential read.
+/// Rows land in `rows` (rowSize ints each, checksums verified; a corrupted row is left
+/// as all -1); returns how many were read.
+int readRowChunk(istream &in, int firstRRN, int maxRows, vector<int> &rows) {
+    vector<int> stored((size_t)maxRows * (rowSize + 1));
+    int got = 0;
+    if (directIndex.active()) {
+        // one page per row in the paged layout
+        while (got < maxRows && directRead(firstRRN + got, &stored[(size_t)got * (rowSize + 1)], rowBytes)) got++;
+    } else if (memoryIndex.active()) {
+        streamoff start = rowOffset(firstRRN);
+        streamoff available = max<streamoff>(0, (streamoff)memoryIndex.image.size() - start);
+        got = (int)min<streamoff>(maxRows, available / rowBytes);
+        memoryRead(start, stored.data(), (size_t)got * rowBytes);
+    } else {
+        in.seekg(rowOffset(firstRRN), ios::beg);
+        in.read(reinterpret_cast<char*>(stored.data()), (streamsize)stored.size() * sizeof(int));
+        got = (int)(in.gcount() / rowBytes);
+        in.clear();
+    }
+
+    rows.assign((size_t)got * rowSize, -1);
+    bool verified = directIndex.active(); // direct pages are checked as they are loaded
+    for (int i = 0; i < got; i++) {
+        const int* src = &stored[(size_t)i * (rowSize + 1)];
+        uint32_t crc;
+        memcpy(&crc, &src[rowSize], sizeof(crc));
+        if (!verified && crc != crc32c(src, rowSize * sizeof(int))) {
+            checksumFailures++;
+            cerr << "Checksum mismatch in node " << firstRRN + i << "\n";
+            continue;   // a corrupted row stays all -1, like an unreadable node
+        }
+        memcpy(&rows[(size_t)i * rowSize], src, rowSize * sizeof(int));
+    }
+    return got;
+}
+
 /// Write a node to the file (keys/refs only)
 void writeNode(fstream &file, const BTreeNode &node) {
     vector<int> row(rowSize, -1);
@@ -60,20 +488,20 @@ void writeNode(fstream &file, const BTreeNode &node) {
     for (int i = 0; i < 5; i++) {
         row[1 + i*2] = node.keys[i];
         row[2 + i*2] = node.refs[i];
+        row[countsOffset + i] = node.counts[i];
     }
 
-    file.seekp(node.selfRRN * rowSize * sizeof(int), ios::beg);
-    file.write(reinterpret_cast<char*>(row.data()), rowSize * sizeof(int));
+    writeRow(file, node.selfRRN, row.data());
 
     //  make sure data is written correctly
     file.flush();
 }
 
-/// Read a node from the file
+/// Read a node from the file.
+/// A row that cannot be read or fails its checksum comes back as an empty node (status -1).
 BTreeNode readNode(fstream &file, int rrn) {
-    vector<int> row(rowSize);
-    file.seekg(rrn * rowSize * sizeof(int), ios::beg);
-    file.read(reinterpret_cast<char*>(row.data()), rowSize * sizeof(int));
+    vector<int> row(rowSize, -1);
+    if (!readRow(file, rrn, row.data())) row.assign(rowSize, -1);
 
     BTreeNode node;
     node.selfRRN = rrn;
@@ -82,12 +510,13 @@ BTreeNode readNode(fstream &file, int rrn) {
     for (int i = 0; i < 5; i++) {
         node.keys[i] = row[1 + i*2];
         node.refs[i] = row[2 + i*2];
+        node.counts[i] = row[countsOffset + i];
     }
 
     return node;
 }
 
-/// Display index file content
+/// Display index file content (every row, streamed in chunks)
 void DisplayIndexFileContent(const char* filename) {
     fstream file(filename, ios::in | ios::binary);
     if (!file) {
@@ -95,33 +524,62 @@ void DisplayIndexFileContent(const char* filename) {
         return;
     }
 
-    for (int i = 0; i < 10; i++) {
-        BTreeNode node = readNode(file, i);
-        cout << node.status << " ";
-        for (int j = 0; j < 5; j++)
-            cout << node.keys[j] << " " << node.refs[j] << " ";
-        cout << "\n";
+    Superblock sb;
+    if (!readSuperblock(file, sb)) return;
+    cout << "superblock: version " << sb.version << ", page " << sb.pageSize
+         << " bytes, " << sb.nodeCount << " nodes, first free " << sb.freeHead << "\n";
+    for (int i = 0; i < catalogCapacity; i++) {
+        if (sb.catalog[i].name[0] != '\0')
+            cout << "index " << sb.catalog[i].name << ": root " << sb.catalog[i].root << "\n";
+    }
+
+    const int chunkRows = 4096;
+    vector<int> rows;
+    for (int first = 1; ; first += chunkRows) {
+        int got = readRowChunk(file, first, chunkRows, rows);
+        for (int i = 0; i < got; i++) {
+            const int* row = &rows[(size_t)i * rowSize];
+            cout << row[0] << " ";
+            for (int j = 0; j < 5; j++)
+                cout << row[1 + j*2] << " " << row[2 + j*2] << " ";
+            cout << "\n";
+        }
+        if (got < chunkRows) break;
     }
 
     file.close();
 }
 
-/// Search a record in the index
+/// Search a record in the index (descends from the root of the active index)
+/// Reference stored for RecordID in a leaf, or -1
+int refInLeaf(const BTreeNode &node, int RecordID) {
+    for (int i = 0; i < 5; i++)
+        if (node.keys[i] == RecordID) return node.refs[i];
+    return -1;
+}
+
+/// keys are max values of subtrees: take the first child whose max >= RecordID
+int childForKey(const BTreeNode &node, int RecordID) {
+    for (int i = 0; i < 5; i++)
+        if (node.keys[i] != -1 && RecordID <= node.keys[i]) return node.refs[i];
+    return -1;
+}
+
 int SearchARecord(const char* filename, int RecordID) {
+    TraceScope trace(TRACE_SEARCH, RecordID);
     fstream file(filename, ios::in | ios::binary);
     if (!file) return -1;
 
-    for (int rrn = 1; rrn < 10; rrn++) {
-        // skip node 0
+    int rrn = GetRootRRN(file);
+    while (rrn != -1) {
         BTreeNode node = readNode(file, rrn);
-        if (node.status == -1) continue;
+        if (node.status == -1) break;
 
-        for (int i = 0; i < 5; i++) {
-            if (node.keys[i] == RecordID) {
-                file.close();
-                return node.refs[i];
-            }
+        if (node.status == 0) {
+            file.close();
+            return refInLeaf(node, RecordID);
         }
+        rrn = childForKey(node, RecordID);
     }
 
     file.close();
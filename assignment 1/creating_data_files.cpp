@@ -14,16 +14,23 @@
 #include <algorithm>
 #include <sstream>
 #include <unordered_map>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 using namespace std;
 
 //// ===================== FILE PATHS =====================
 // These are the files used for storing the main data and their index files.
 const string doctorDataFile = "Doctors.txt";
 const string appointmentDataFile = "Appointments.txt";
-const string doctorPrimaryIndexFile = "DoctorPrimaryIndex.txt";
-const string appointmentPrimaryIndexFile = "AppointmentPrimaryIndex.txt";
-const string doctorSecondaryIndexFile = "DoctorSecondaryIndex.txt";
-const string appointmentSecondaryIndexFile = "AppointmentSecondaryIndex.txt";
+const string doctorPrimaryIndexFile = "DoctorPrimaryIndex.idx";
+const string appointmentPrimaryIndexFile = "AppointmentPrimaryIndex.idx";
+const string doctorSecondaryIndexFile = "DoctorSecondaryIndex.idx";
+const string appointmentSecondaryIndexFile = "AppointmentSecondaryIndex.idx";
+const string doctorPrimaryHashFile = "DoctorPrimaryIndex.hash";
+const string appointmentPrimaryHashFile = "AppointmentPrimaryIndex.hash";
 
 //// ===================== STRUCT DEFINITIONS =====================
 // Each record in the primary index stores (ID, offset)
@@ -48,6 +55,127 @@ struct SecondaryIndex {
     }
 };
 
+// The index files hold the structs above as fixed-width binary entries
+static_assert(sizeof(PrimaryIndex) == 28, "primary index entry must stay 28 bytes");
+static_assert(sizeof(SecondaryIndex) == 30, "secondary index entry must stay 30 bytes");
+
+//// ===================== MAPPED FILES =====================
+// A file is mapped read-only on first use and kept until this program writes
+// it again (unmapFile), so repeated reads cost no system calls
+
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;   // false = map on the next read
+};
+
+static unordered_map<string, MappedFile> mappedFiles;
+
+static void unmapFile(const string &fileName) {
+    auto it = mappedFiles.find(fileName);
+    if (it == mappedFiles.end()) return;
+    if (it->second.data) munmap((void*)it->second.data, it->second.size);
+    mappedFiles.erase(it);
+}
+
+static const MappedFile& mapFile(const string &fileName) {
+    MappedFile &m = mappedFiles[fileName];
+    if (m.mapped) return m;
+    m.mapped = true;
+
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd == -1) return m;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            m.data = (const char*)p;
+            m.size = (size_t)st.st_size;
+        }
+    }
+    close(fd);
+    return m;
+}
+
+//// ===================== BINARY INDEX FORMAT =====================
+// An index file is a header followed by `count` sorted fixed-width entries,
+// so it can be binary-searched straight from its mapping
+
+struct IndexFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t entrySize;
+};
+
+const uint32_t indexFormatVersion = 1;
+const char primaryIndexMagic[4] = {'P', 'I', 'D', 'X'};
+const char secondaryIndexMagic[4] = {'S', 'I', 'D', 'X'};
+
+// Read-only view of sorted entries, over a vector or over a mapped index file
+template <typename T>
+struct EntrySpan {
+    const T* first = nullptr;
+    size_t count = 0;
+
+    EntrySpan() {}
+    EntrySpan(const T* p, size_t n) : first(p), count(n) {}
+    EntrySpan(const vector<T> &v) : first(v.data()), count(v.size()) {}
+
+    const T* begin() const { return first; }
+    const T* end() const { return first + count; }
+    size_t size() const { return count; }
+    const T& operator[](size_t i) const { return first[i]; }
+};
+
+// The entries of an index file; empty if it is missing or not in this format
+template <typename T>
+EntrySpan<T> mappedEntries(const string &fileName, const char magic[4]) {
+    const MappedFile &m = mapFile(fileName);
+    IndexFileHeader h;
+    if (m.size < sizeof(h)) return {};
+    memcpy(&h, m.data, sizeof(h));
+    if (memcmp(h.magic, magic, 4) != 0 || h.version != indexFormatVersion || h.entrySize != sizeof(T) ||
+        sizeof(h) + (size_t)h.count * sizeof(T) > m.size) return {};
+    return EntrySpan<T>((const T*)(m.data + sizeof(h)), h.count);
+}
+
+template <typename T>
+void writeIndexFile(const vector<T> &entries, const string &fileName, const char magic[4]) {
+    unmapFile(fileName);
+    IndexFileHeader h;
+    memcpy(h.magic, magic, 4);
+    h.version = indexFormatVersion;
+    h.count = (uint32_t)entries.size();
+    h.entrySize = sizeof(T);
+    ofstream out(fileName, ios::binary | ios::trunc);
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)entries.data(), (streamsize)(entries.size() * sizeof(T)));
+}
+
+//// ===================== INDEX ORDER =====================
+// Both indexes are sorted ignoring the '*' delete mark, with the active entry
+// before the deleted one when the IDs match
+
+static const char* unmarked(const char* id) {
+    return id[0] == '*' ? id + 1 : id;
+}
+
+bool primaryEntryLess(const PrimaryIndex &a, const PrimaryIndex &b) {
+    int cmp = strcmp(unmarked(a.recordID), unmarked(b.recordID));
+    if (cmp != 0) return cmp < 0;
+    return a.recordID[0] != '*' && b.recordID[0] == '*';
+}
+
+bool secondaryEntryLess(const SecondaryIndex &a, const SecondaryIndex &b) {
+    int cmp = strcmp(unmarked(a.keyValue), unmarked(b.keyValue));
+    if (cmp != 0) return cmp < 0;
+    cmp = strcmp(unmarked(a.linkedID), unmarked(b.linkedID));
+    if (cmp != 0) return cmp < 0;
+    if (a.keyValue[0] != b.keyValue[0]) return a.keyValue[0] != '*';
+    return a.linkedID[0] != '*' && b.linkedID[0] == '*';
+}
+
 //// ===================== HELPER FUNCTION =====================
 // Splits a line of text into parts using the given delimiter ('|')
 vector<string> split(const string &line, char delim = '|') {
@@ -59,70 +187,516 @@ vector<string> split(const string &line, char delim = '|') {
     return parts;
 }
 
+//// ===================== POSITIONAL INSERT / ERASE =====================
+// A change is applied to the sorted vector in place instead of rebuilding the
+// whole index. Finding the position is a binary search, O(log n); the insert
+// or erase itself still shifts the entries after it (one memmove, O(n)), since
+// the index files and EntrySpan need the entries contiguous
+
+void insertPrimaryEntry(vector<PrimaryIndex> &indexList, const char *recordID, long long offset,
+                        int recordLength) {
+    PrimaryIndex entry;
+    strncpy(entry.recordID, recordID, sizeof(entry.recordID) - 1);
+    entry.recordID[sizeof(entry.recordID) - 1] = '\0';
+    entry.offset = (int)offset;
+    entry.recordLength = recordLength;
+    indexList.insert(upper_bound(indexList.begin(), indexList.end(), entry, primaryEntryLess), entry);
+}
+
+// recordLength, when given, receives the length stored in the erased entry
+bool erasePrimaryEntry(vector<PrimaryIndex> &indexList, const char *recordID, long long offset,
+                       int *recordLength = nullptr) {
+    PrimaryIndex probe;
+    strncpy(probe.recordID, recordID, sizeof(probe.recordID) - 1);
+    probe.recordID[sizeof(probe.recordID) - 1] = '\0';
+    auto range = equal_range(indexList.begin(), indexList.end(), probe, primaryEntryLess);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (strcmp(it->recordID, probe.recordID) == 0 && it->offset == offset) {
+            if (recordLength) *recordLength = it->recordLength;
+            indexList.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void insertSecondaryEntry(vector<SecondaryIndex> &indexList, const char *key, const char *linkedID) {
+    SecondaryIndex entry;
+    strncpy(entry.keyValue, key, sizeof(entry.keyValue) - 1);
+    entry.keyValue[sizeof(entry.keyValue) - 1] = '\0';
+    strncpy(entry.linkedID, linkedID, sizeof(entry.linkedID) - 1);
+    entry.linkedID[sizeof(entry.linkedID) - 1] = '\0';
+    indexList.insert(upper_bound(indexList.begin(), indexList.end(), entry, secondaryEntryLess), entry);
+}
+
+bool eraseSecondaryEntry(vector<SecondaryIndex> &indexList, const char *key, const char *linkedID) {
+    SecondaryIndex probe;
+    strncpy(probe.keyValue, key, sizeof(probe.keyValue) - 1);
+    probe.keyValue[sizeof(probe.keyValue) - 1] = '\0';
+    strncpy(probe.linkedID, linkedID, sizeof(probe.linkedID) - 1);
+    probe.linkedID[sizeof(probe.linkedID) - 1] = '\0';
+    auto it = lower_bound(indexList.begin(), indexList.end(), probe, secondaryEntryLess);
+    if (it == indexList.end() || strcmp(it->keyValue, probe.keyValue) != 0 ||
+        strcmp(it->linkedID, probe.linkedID) != 0) return false;
+    indexList.erase(it);
+    return true;
+}
+
+//// ===================== DELTA LOG =====================
+// Changes made after an index file was written are appended to "<index>.log",
+// one "+|a|b" (insert) or "-|a|b" (erase) line each; a primary insert also
+// carries the record length ("+|id|offset|length"). Reading the index replays
+// its log; writing the whole index again (compaction) empties the log.
+
+const size_t deltaLogLimit = 1024;              // logged changes before compaction
+unordered_map<string, size_t> deltaLogLength;   // index file -> lines in its log
+
+string deltaLogFile(const string &indexFile) {
+    return indexFile + ".log";
+}
+
+void clearDeltaLog(const string &indexFile) {
+    remove(deltaLogFile(indexFile).c_str());
+    deltaLogLength[indexFile] = 0;
+}
+
+void appendDelta(const string &indexFile, char op, const string &a, const string &b,
+                 const string &c = "") {
+    ofstream out(deltaLogFile(indexFile), ios::app);
+    out << op << "|" << a << "|" << b;
+    if (!c.empty()) out << "|" << c;
+    out << "\n";
+    deltaLogLength[indexFile]++;
+}
+
+// Reads the log as (op, a, b) triples, (op, a, b, c) for lines with a fourth field
+vector<vector<string>> readDeltaLog(const string &indexFile) {
+    vector<vector<string>> changes;
+    ifstream in(deltaLogFile(indexFile));
+    string line;
+    while (getline(in, line)) {
+        auto fields = split(line);
+        if ((fields.size() == 3 || fields.size() == 4) && (fields[0] == "+" || fields[0] == "-"))
+            changes.push_back(fields);
+    }
+    deltaLogLength[indexFile] = changes.size();
+    return changes;
+}
+
 //// ===================== WRITE FUNCTIONS =====================
-// Writes the primary index (ID|Offset) to a file
+// Writes the primary index (ID, offset) to a binary index file
 void writePrimaryIndex(const vector<PrimaryIndex> &indexList, const string &fileName) {
-    ofstream out(fileName);
-    for (const auto &entry : indexList) {
-        out << entry.recordID << "|" << entry.offset << "\n";
+    // copy the fields only, so unused bytes after the IDs are written as zeros
+    vector<PrimaryIndex> entries(indexList.size());
+    for (size_t i = 0; i < indexList.size(); ++i) {
+        memset(&entries[i], 0, sizeof(PrimaryIndex));
+        strncpy(entries[i].recordID, indexList[i].recordID, sizeof(entries[i].recordID) - 1);
+        entries[i].offset = indexList[i].offset;
+        entries[i].recordLength = indexList[i].recordLength;
     }
-    out.close();
+    writeIndexFile(entries, fileName, primaryIndexMagic);
+    clearDeltaLog(fileName);
 }
 
-// Writes the secondary index (Key|ID) to a file
+// Writes the secondary index (Key, ID) to a binary index file
 void writeSecondaryIndex(const vector<SecondaryIndex> &indexList, const string &fileName) {
-    ofstream out(fileName);
-    for (auto &entry : indexList)
-        out << entry.keyValue << "|" << entry.linkedID << "\n";
-    out.close();
+    vector<SecondaryIndex> entries(indexList.size());
+    for (size_t i = 0; i < indexList.size(); ++i) {
+        memset(&entries[i], 0, sizeof(SecondaryIndex));
+        strncpy(entries[i].keyValue, indexList[i].keyValue, sizeof(entries[i].keyValue) - 1);
+        strncpy(entries[i].linkedID, indexList[i].linkedID, sizeof(entries[i].linkedID) - 1);
+    }
+    writeIndexFile(entries, fileName, secondaryIndexMagic);
+    clearDeltaLog(fileName);
 }
 
 //// ===================== READ FUNCTIONS =====================
-// Reads all records from a primary index file into memory
-vector<PrimaryIndex> readPrimaryIndex(const string &fileName) {
-    vector<PrimaryIndex> indexList;
-    ifstream in(fileName);
-    string line;
+// The add / update / delete paths edit the index in memory, so they start from
+// a copy; read-only lookups use the views below instead
 
-    while (getline(in, line)) {
-        if (line.empty()) continue;
-        size_t pos = line.find('|');
-        if (pos == string::npos) continue;
-        PrimaryIndex entry;
-        strcpy(entry.recordID, line.substr(0, pos).c_str());
-        entry.offset = stoll(line.substr(pos + 1));
-        indexList.push_back(entry);
+// Copies a primary index file into memory and applies its delta log
+vector<PrimaryIndex> readPrimaryIndex(const string &fileName) {
+    EntrySpan<PrimaryIndex> stored = mappedEntries<PrimaryIndex>(fileName, primaryIndexMagic);
+    vector<PrimaryIndex> indexList(stored.begin(), stored.end());
+    for (auto &change : readDeltaLog(fileName)) {
+        if (change[0] == "+")
+            insertPrimaryEntry(indexList, change[1].c_str(), stoll(change[2]),
+                               change.size() == 4 ? stoi(change[3]) : 0);
+        else erasePrimaryEntry(indexList, change[1].c_str(), stoll(change[2]));
     }
-
-    in.close();
     return indexList;
 }
 
-// Reads all records from a secondary index file into memory
+// Copies a secondary index file into memory and applies its delta log
 vector<SecondaryIndex> readSecondaryIndex(const string &fileName) {
-    vector<SecondaryIndex> indexList;
-    ifstream in(fileName);
-    string line;
+    EntrySpan<SecondaryIndex> stored = mappedEntries<SecondaryIndex>(fileName, secondaryIndexMagic);
+    vector<SecondaryIndex> indexList(stored.begin(), stored.end());
+    for (auto &change : readDeltaLog(fileName)) {
+        if (change[0] == "+") insertSecondaryEntry(indexList, change[1].c_str(), change[2].c_str());
+        else eraseSecondaryEntry(indexList, change[1].c_str(), change[2].c_str());
+    }
+    return indexList;
+}
+
+//// ===================== INDEX VIEWS =====================
+// Read-only access straight from the mapped index file. The delta log is
+// replayed into two small sorted overlays instead of a copy of the file: the
+// entries it added and the stored entries it erased. A lookup binary-searches
+// the mapping, drops what the overlay erased and merges in what it added.
+
+template <typename T>
+struct IndexView {
+    EntrySpan<T> stored;   // sorted entries of the mapped file
+    vector<T> added;       // logged inserts, sorted
+    vector<T> removed;     // logged erases of stored entries, sorted
+};
 
-    if (!in.is_open()) {
-        cout << "DEBUG: Could not open " << fileName << " for reading\n";
-        return indexList;
+typedef IndexView<PrimaryIndex> PrimaryIndexView;
+typedef IndexView<SecondaryIndex> SecondaryIndexView;
+
+PrimaryIndexView openPrimaryIndex(const string &fileName) {
+    PrimaryIndexView view;
+    view.stored = mappedEntries<PrimaryIndex>(fileName, primaryIndexMagic);
+    for (auto &change : readDeltaLog(fileName)) {
+        const char *id = change[1].c_str();
+        long long offset = stoll(change[2]);
+        if (change[0] == "+") {
+            // re-adding an erased stored entry just cancels the erase
+            if (!erasePrimaryEntry(view.removed, id, offset))
+                insertPrimaryEntry(view.added, id, offset, change.size() == 4 ? stoi(change[3]) : 0);
+        } else if (!erasePrimaryEntry(view.added, id, offset)) {
+            insertPrimaryEntry(view.removed, id, offset, 0);
+        }
     }
+    return view;
+}
 
-    while (getline(in, line)) {
-        if (line.empty()) continue;
-        size_t pos = line.find('|');
-        if (pos == string::npos) continue;
-        SecondaryIndex entry;
-        string key = line.substr(0, pos);
-        string id = line.substr(pos + 1);
-        strcpy(entry.keyValue, key.c_str());
-        strcpy(entry.linkedID, id.c_str());
-        indexList.push_back(entry);
+SecondaryIndexView openSecondaryIndex(const string &fileName) {
+    SecondaryIndexView view;
+    view.stored = mappedEntries<SecondaryIndex>(fileName, secondaryIndexMagic);
+    for (auto &change : readDeltaLog(fileName)) {
+        const char *key = change[1].c_str(), *linkedID = change[2].c_str();
+        if (change[0] == "+") {
+            if (!eraseSecondaryEntry(view.removed, key, linkedID))
+                insertSecondaryEntry(view.added, key, linkedID);
+        } else if (!eraseSecondaryEntry(view.added, key, linkedID)) {
+            insertSecondaryEntry(view.removed, key, linkedID);
+        }
     }
+    return view;
+}
 
-    in.close();
-    return indexList;
+// Entries of the view for one ID (either mark), in index order
+vector<PrimaryIndex> primaryEntriesFor(const PrimaryIndexView &view, const char *id) {
+    auto idLess = [](const PrimaryIndex &a, const PrimaryIndex &b) {
+        return strcmp(unmarked(a.recordID), unmarked(b.recordID)) < 0;
+    };
+    PrimaryIndex probe;
+    strncpy(probe.recordID, id, sizeof(probe.recordID) - 1);
+    probe.recordID[sizeof(probe.recordID) - 1] = '\0';
+
+    auto stored = equal_range(view.stored.begin(), view.stored.end(), probe, idLess);
+    auto removed = equal_range(view.removed.begin(), view.removed.end(), probe, idLess);
+    vector<PrimaryIndex> erased(removed.first, removed.second);
+    vector<PrimaryIndex> entries;
+    for (auto it = stored.first; it != stored.second; ++it)
+        if (!erasePrimaryEntry(erased, it->recordID, it->offset)) entries.push_back(*it);
+    auto added = equal_range(view.added.begin(), view.added.end(), probe, idLess);
+    entries.insert(entries.end(), added.first, added.second);
+    stable_sort(entries.begin(), entries.end(), primaryEntryLess);
+    return entries;
+}
+
+// Entries of the view for one key (either mark), in index order
+vector<SecondaryIndex> secondaryEntriesFor(const SecondaryIndexView &view, const char *key) {
+    auto keyLess = [](const SecondaryIndex &a, const SecondaryIndex &b) {
+        return strcmp(unmarked(a.keyValue), unmarked(b.keyValue)) < 0;
+    };
+    SecondaryIndex probe;
+    strncpy(probe.keyValue, key, sizeof(probe.keyValue) - 1);
+    probe.keyValue[sizeof(probe.keyValue) - 1] = '\0';
+
+    auto stored = equal_range(view.stored.begin(), view.stored.end(), probe, keyLess);
+    auto removed = equal_range(view.removed.begin(), view.removed.end(), probe, keyLess);
+    vector<SecondaryIndex> erased(removed.first, removed.second);
+    vector<SecondaryIndex> entries;
+    for (auto it = stored.first; it != stored.second; ++it)
+        if (!eraseSecondaryEntry(erased, it->keyValue, it->linkedID)) entries.push_back(*it);
+    auto added = equal_range(view.added.begin(), view.added.end(), probe, keyLess);
+    entries.insert(entries.end(), added.first, added.second);
+    stable_sort(entries.begin(), entries.end(), secondaryEntryLess);
+    return entries;
+}
+
+//// ===================== INCREMENTAL UPDATES =====================
+// Logged versions used by the add / update / delete operations; the index
+// file is rewritten once the log reaches deltaLogLimit changes
+void addPrimaryEntry(vector<PrimaryIndex> &indexList, const string &indexFile,
+                     const char *recordID, long long offset, int recordLength) {
+    insertPrimaryEntry(indexList, recordID, offset, recordLength);
+    appendDelta(indexFile, '+', recordID, to_string(offset), to_string(recordLength));
+    if (deltaLogLength[indexFile] >= deltaLogLimit) writePrimaryIndex(indexList, indexFile);
+}
+
+bool removePrimaryEntry(vector<PrimaryIndex> &indexList, const string &indexFile,
+                        const char *recordID, long long offset, int *recordLength = nullptr) {
+    if (!erasePrimaryEntry(indexList, recordID, offset, recordLength)) return false;
+    appendDelta(indexFile, '-', recordID, to_string(offset));
+    if (deltaLogLength[indexFile] >= deltaLogLimit) writePrimaryIndex(indexList, indexFile);
+    return true;
+}
+
+void addSecondaryEntry(vector<SecondaryIndex> &indexList, const string &indexFile,
+                       const char *key, const char *linkedID) {
+    insertSecondaryEntry(indexList, key, linkedID);
+    appendDelta(indexFile, '+', key, linkedID);
+    if (deltaLogLength[indexFile] >= deltaLogLimit) writeSecondaryIndex(indexList, indexFile);
+}
+
+bool removeSecondaryEntry(vector<SecondaryIndex> &indexList, const string &indexFile,
+                          const char *key, const char *linkedID) {
+    if (!eraseSecondaryEntry(indexList, key, linkedID)) return false;
+    appendDelta(indexFile, '-', key, linkedID);
+    if (deltaLogLength[indexFile] >= deltaLogLimit) writeSecondaryIndex(indexList, indexFile);
+    return true;
+}
+
+// Puts '*' on the key of every entry under it, as the rebuild does for the
+// appointments of a deleted doctor
+void markSecondaryKeyDeleted(vector<SecondaryIndex> &indexList, const string &indexFile, const char *key) {
+    SecondaryIndex probe;
+    strncpy(probe.keyValue, key, sizeof(probe.keyValue) - 1);
+    probe.keyValue[sizeof(probe.keyValue) - 1] = '\0';
+    probe.linkedID[0] = '\0';
+
+    vector<string> linked;
+    for (auto it = lower_bound(indexList.begin(), indexList.end(), probe, secondaryEntryLess);
+         it != indexList.end() && strcmp(unmarked(it->keyValue), probe.keyValue) == 0; ++it) {
+        if (it->keyValue[0] != '*') linked.push_back(it->linkedID);
+    }
+    string deletedKey = string("*") + probe.keyValue;
+    for (auto &id : linked) {
+        removeSecondaryEntry(indexList, indexFile, probe.keyValue, id.c_str());
+        addSecondaryEntry(indexList, indexFile, deletedKey.c_str(), id.c_str());
+    }
+}
+
+//// ===================== HASH INDEX =====================
+// Optional exact-match index on the ID of every active record: an open
+// addressing table with Robin Hood probing, mapped read/write. Slots are 32
+// bytes (two per cache line) and the table is kept at most 3/4 full, so a
+// lookup nearly always ends in the first slot it reads.
+
+struct HashFileHeader {
+    char magic[4];          // "HIDX"
+    uint32_t version;
+    uint32_t capacity;      // number of slots, a power of two
+    uint32_t count;         // used slots
+    uint32_t reserved[4];   // keeps the slots 32-byte aligned
+};
+
+struct HashSlot {
+    char id[24];            // NUL padded
+    int32_t offset;
+    int32_t distance;       // probes from the home slot, -1 = empty
+};
+
+static_assert(sizeof(HashSlot) == 32, "hash slots must stay 32 bytes");
+
+const uint32_t hashFormatVersion = 1;
+const char hashIndexMagic[4] = {'H', 'I', 'D', 'X'};
+bool hashPrimaryIndex = false;    // build and use the hash files
+
+struct HashTable {
+    int fd = -1;
+    char* base = nullptr;
+    size_t size = 0;
+    bool opened = false;    // false = try to open on the next use
+
+    HashFileHeader& header() { return *(HashFileHeader*)base; }
+    HashSlot* slots() { return (HashSlot*)(base + sizeof(HashFileHeader)); }
+};
+
+static unordered_map<string, HashTable> hashTables;
+
+static uint64_t hashID(const char *id) {
+    uint64_t h = 1469598103934665603ULL;   // FNV-1a
+    for (size_t i = 0; i < sizeof(HashSlot::id) && id[i]; ++i) {
+        h ^= (unsigned char)id[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static bool slotHolds(const HashSlot &slot, const char *id) {
+    return strncmp(slot.id, id, sizeof(slot.id)) == 0;
+}
+
+static void closeHashIndex(const string &fileName) {
+    auto it = hashTables.find(fileName);
+    if (it == hashTables.end()) return;
+    if (it->second.base) munmap(it->second.base, it->second.size);
+    if (it->second.fd != -1) close(it->second.fd);
+    hashTables.erase(it);
+}
+
+// The mapped table, nullptr when the file is missing or not a hash index
+static HashTable* openHashIndex(const string &fileName) {
+    HashTable &t = hashTables[fileName];
+    if (t.opened) return t.base ? &t : nullptr;
+    t.opened = true;
+
+    t.fd = open(fileName.c_str(), O_RDWR);
+    if (t.fd == -1) return nullptr;
+    struct stat st;
+    if (fstat(t.fd, &st) == 0 && (size_t)st.st_size >= sizeof(HashFileHeader)) {
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, t.fd, 0);
+        if (p != MAP_FAILED) {
+            t.base = (char*)p;
+            t.size = (size_t)st.st_size;
+        }
+    }
+    if (t.base) {
+        HashFileHeader &h = t.header();
+        if (memcmp(h.magic, hashIndexMagic, 4) != 0 || h.version != hashFormatVersion ||
+            t.size != sizeof(HashFileHeader) + (size_t)h.capacity * sizeof(HashSlot)) {
+            munmap(t.base, t.size);
+            t.base = nullptr;
+        }
+    }
+    return t.base ? &t : nullptr;
+}
+
+// Writes an empty table with `capacity` slots
+static bool createHashFile(const string &fileName, uint32_t capacity) {
+    closeHashIndex(fileName);
+    HashFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, hashIndexMagic, 4);
+    h.version = hashFormatVersion;
+    h.capacity = capacity;
+    HashSlot empty;
+    memset(&empty, 0, sizeof(empty));
+    empty.distance = -1;
+    vector<HashSlot> slots(capacity, empty);
+
+    ofstream out(fileName, ios::binary | ios::trunc);
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)slots.data(), (streamsize)(slots.size() * sizeof(HashSlot)));
+    return (bool)out;
+}
+
+static uint32_t hashCapacityFor(size_t entries) {
+    uint32_t capacity = 16;
+    while (capacity * 3 / 4 < entries + 1) capacity *= 2;
+    return capacity;
+}
+
+// Robin Hood placement: an entry takes the slot of one that sits closer to its home
+static void placeHashEntry(HashTable &t, HashSlot entry) {
+    uint32_t mask = t.header().capacity - 1;
+    uint32_t pos = (uint32_t)(hashID(entry.id) & mask);
+    entry.distance = 0;
+    while (true) {
+        HashSlot &slot = t.slots()[pos];
+        if (slot.distance == -1) {
+            slot = entry;
+            t.header().count++;
+            return;
+        }
+        // an existing key is always met before any swap could happen
+        if (slotHolds(slot, entry.id)) {
+            slot.offset = entry.offset;
+            return;
+        }
+        if (slot.distance < entry.distance) swap(slot, entry);
+        pos = (pos + 1) & mask;
+        entry.distance++;
+    }
+}
+
+// Rewrites the table with room for `entries` records
+static HashTable* rebuildHashFile(const string &fileName, const vector<HashSlot> &entries) {
+    if (!createHashFile(fileName, hashCapacityFor(entries.size()))) return nullptr;
+    HashTable* t = openHashIndex(fileName);
+    if (!t) return nullptr;
+    for (const auto &entry : entries) placeHashEntry(*t, entry);
+    return t;
+}
+
+// Builds the hash file from the active entries of a primary index
+void buildHashIndex(const vector<PrimaryIndex> &primary, const string &hashFile) {
+    vector<HashSlot> entries;
+    for (const auto &e : primary) {
+        if (e.recordID[0] == '*') continue;
+        HashSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        strncpy(slot.id, e.recordID, sizeof(slot.id) - 1);
+        slot.offset = e.offset;
+        entries.push_back(slot);
+    }
+    rebuildHashFile(hashFile, entries);
+}
+
+// false when there is no hash file; otherwise offset is the record's, or -1
+bool hashLookup(const string &hashFile, const char *id, long long &offset) {
+    HashTable* t = openHashIndex(hashFile);
+    if (!t) return false;
+    uint32_t mask = t->header().capacity - 1;
+    uint32_t pos = (uint32_t)(hashID(id) & mask);
+    offset = -1;
+    for (int32_t distance = 0;; ++distance) {
+        const HashSlot &slot = t->slots()[pos];
+        // past the point where a Robin Hood table could still hold the key
+        if (slot.distance == -1 || slot.distance < distance) return true;
+        if (slotHolds(slot, id)) {
+            offset = slot.offset;
+            return true;
+        }
+        pos = (pos + 1) & mask;
+    }
+}
+
+// Adds or moves an ID; does nothing when there is no hash file
+void hashInsert(const string &hashFile, const char *id, long long offset) {
+    HashTable* t = openHashIndex(hashFile);
+    if (!t) return;
+    if ((t->header().count + 1) * 4 > t->header().capacity * 3) {
+        // grow: copy the entries out, then rebuild at the next capacity
+        vector<HashSlot> entries;
+        for (uint32_t i = 0; i < t->header().capacity; ++i)
+            if (t->slots()[i].distance != -1) entries.push_back(t->slots()[i]);
+        t = rebuildHashFile(hashFile, entries);
+        if (!t) return;
+    }
+    HashSlot entry;
+    memset(&entry, 0, sizeof(entry));
+    strncpy(entry.id, id, sizeof(entry.id) - 1);
+    entry.offset = (int32_t)offset;
+    placeHashEntry(*t, entry);
+}
+
+// Removes an ID, shifting the following run back one slot (no tombstones)
+void hashErase(const string &hashFile, const char *id) {
+    HashTable* t = openHashIndex(hashFile);
+    if (!t) return;
+    uint32_t mask = t->header().capacity - 1;
+    uint32_t pos = (uint32_t)(hashID(id) & mask);
+    for (int32_t distance = 0;; ++distance) {
+        HashSlot &slot = t->slots()[pos];
+        if (slot.distance == -1 || slot.distance < distance) return;
+        if (slotHolds(slot, id)) break;
+        pos = (pos + 1) & mask;
+    }
+    uint32_t next = (pos + 1) & mask;
+    while (t->slots()[next].distance > 0) {
+        t->slots()[pos] = t->slots()[next];
+        t->slots()[pos].distance--;
+        pos = next;
+        next = (next + 1) & mask;
+    }
+    t->slots()[pos].distance = -1;
+    t->header().count--;
 }
 
 //// ===================== INDEX BUILDING FUNCTIONS =====================
@@ -139,11 +713,12 @@ vector<PrimaryIndex> buildPrimaryIndexLength(const string &dataFile,
 
     // Read each record line-by-line
     while (getline(in, line)) {
-        if (line.empty()) continue;
+        // A blank line holds no record but still takes its newline byte
+        if (line.empty()) { currentOffset += 1; continue; }
 
         // Check if the record is marked deleted
-        // Remove the '*' mark if deleted to extract clean fields
-        string cleanLine = (line[0] == '*') ? line.substr(1) : line;
+        // Remove the status byte (' ' or '*') to extract clean fields
+        string cleanLine = (line[0] == '*' || line[0] == ' ') ? line.substr(1) : line;
 
         auto fields = split(cleanLine);
         if (fields.size() <= idFieldIndex) continue;
@@ -169,19 +744,7 @@ vector<PrimaryIndex> buildPrimaryIndexLength(const string &dataFile,
     in.close();
 
     // Sort primary index alphabetically, but IGNORE '*' when comparing
-    sort(primaryIndex.begin(), primaryIndex.end(),
-         [](const PrimaryIndex &a, const PrimaryIndex &b) {
-             // Compare IDs without '*' prefix
-             string A = (a.recordID[0] == '*') ? a.recordID + 1 : a.recordID;
-             string B = (b.recordID[0] == '*') ? b.recordID + 1 : b.recordID;
-
-             // If IDs match, keep non-deleted first
-             if (A == B) return a.recordID[0] != '*';
-
-             // Normal alphabetical comparison
-             return A < B;
-         }
-    );
+    sort(primaryIndex.begin(), primaryIndex.end(), primaryEntryLess);
 
     writePrimaryIndex(primaryIndex, indexFile); // Store index into a file
     return primaryIndex;
@@ -208,7 +771,7 @@ vector<SecondaryIndex> buildSecondaryIndex(const string &appointmentsFile,
     while (getline(docIn, line)) {
         if (line.empty()) continue;
 
-        string cleanLine = (line[0] == '*') ? line.substr(1) : line;
+        string cleanLine = (line[0] == '*' || line[0] == ' ') ? line.substr(1) : line;
 
         auto fields = split(cleanLine);
         if (fields.size() < 4) continue;
@@ -222,7 +785,7 @@ vector<SecondaryIndex> buildSecondaryIndex(const string &appointmentsFile,
     while (getline(appIn, line)) {
         if (line.empty()) continue;
 
-        string cleanLine = (line[0] == '*') ? line.substr(1) : line;
+        string cleanLine = (line[0] == '*' || line[0] == ' ') ? line.substr(1) : line;
 
         auto fields = split(cleanLine);
         if (fields.size() <= max(keyFieldIndex, linkedFieldIndex)) continue;
@@ -248,36 +811,8 @@ vector<SecondaryIndex> buildSecondaryIndex(const string &appointmentsFile,
 
     appIn.close();
 
-    //Sort secondary index
-    sort(secondaryIndex.begin(), secondaryIndex.end(),
-         [](const SecondaryIndex &a, const SecondaryIndex &b) {
-
-             // Compare doctorID without '*'
-             string keyA = (a.keyValue[0] == '*') ? a.keyValue + 1 : a.keyValue;
-             string keyB = (b.keyValue[0] == '*') ? b.keyValue + 1 : b.keyValue;
-
-             if (keyA != keyB)
-                 // Primary sort: doctorID
-                 return keyA < keyB;
-
-             // Compare appointmentID without '*'
-             string idA = (a.linkedID[0] == '*') ? a.linkedID + 1 : a.linkedID;
-             string idB = (b.linkedID[0] == '*') ? b.linkedID + 1 : b.linkedID;
-
-             if (idA != idB)
-                 // Secondary sort: appointmentID
-                 return idA < idB;
-
-             // Non-deleted should appear before deleted
-             if (a.keyValue[0] != b.keyValue[0])
-                 return a.keyValue[0] != '*';
-
-             if (a.linkedID[0] != b.linkedID[0])
-                 return a.linkedID[0] != '*';
-
-             return false;
-         }
-    );
+    //Sort secondary index by key then linked ID, ignoring '*'
+    sort(secondaryIndex.begin(), secondaryIndex.end(), secondaryEntryLess);
 
     writeSecondaryIndex(secondaryIndex, indexFile);  // Write index to file
     return secondaryIndex;
@@ -292,4 +827,8 @@ void Build_indexes(){
     auto doctorSecondary = buildSecondaryIndex(doctorDataFile,doctorDataFile, doctorSecondaryIndexFile, 1, 3);
     auto appointmentPrimary = buildPrimaryIndexLength(appointmentDataFile, appointmentPrimaryIndexFile, 1);
     auto appointmentSecondary = buildSecondaryIndex(appointmentDataFile,doctorDataFile,appointmentSecondaryIndexFile, 2, 1);
+    if (hashPrimaryIndex) {
+        buildHashIndex(doctorPrimary, doctorPrimaryHashFile);
+        buildHashIndex(appointmentPrimary, appointmentPrimaryHashFile);
+    }
 }
\ No newline at end of file
@@ -33,12 +33,13 @@ static string stripQuotes(string s){
     return s;
 }
 
-// Simple query executor for three supported forms
+// Simple query executor for three supported forms; it only reads, so it works
+// on views of the mapped index files
 static void executeQuery(const string &query,
-                         vector<PrimaryIndex> &doctorPrimary,
-                         vector<SecondaryIndex> &doctorSecondary,
-                         vector<PrimaryIndex> &apptPrimary,
-                         vector<SecondaryIndex> &apptSecondary){
+                         const PrimaryIndexView &doctorPrimary,
+                         const SecondaryIndexView &doctorSecondary,
+                         const PrimaryIndexView &apptPrimary,
+                         const SecondaryIndexView &apptSecondary){
     string q = trim(query);
     if(q.empty()){
         cout << "Empty query\n";
@@ -58,11 +59,8 @@ static void executeQuery(const string &query,
 
         long long off = resolveActiveOffsetForID(doctorPrimary, doctorDataFile, value.c_str());
         if(off == -1){ cout << "ID not found\n"; return; }
-        string line = readLineAtOffset(doctorDataFile, off);
-        if(!line.empty() && line[0] != DELETE_FLAG){
-            Doctor d = Doctor::fromLine(line);
-
-
+        DoctorView d = DoctorView::at(doctorDataFile, off);
+        if(d.isActive()){
             cout << d;
         } else {
             cout << "Deleted or not present in file\n";
@@ -100,11 +98,8 @@ static void executeQuery(const string &query,
         for(const auto &id : ids){
             long long off = resolveActiveOffsetForID(doctorPrimary, doctorDataFile, id.c_str());
             if(off != -1){
-                string line = readLineAtOffset(doctorDataFile, off);
-                if(!line.empty() && line[0] != DELETE_FLAG){
-                    Doctor d = Doctor::fromLine(line);
-                    if(!d.isEmpty()) cout << d.Name << "\n";
-                }
+                DoctorView d = DoctorView::at(doctorDataFile, off);
+                if(d.isActive()) cout << d.Name << "\n";
             }
         }
         return;
@@ -123,9 +118,6 @@ static void executeQuery(const string &query,
 //    vector<PrimaryIndex> apptPrimary = readPrimaryIndex(appointmentPrimaryIndexFile);
 //    vector<SecondaryIndex> apptSecondary = readSecondaryIndex(appointmentSecondaryIndexFile);
 //
-//    vector<int> doctorAvail = buildAvailRRNsFromFile(doctorDataFile);
-//    vector<int> apptAvail = buildAvailRRNsFromFile(appointmentDataFile);
-//
 //    while(true){
 //        cout << "\n=== Main Menu ===\n";
 //        cout << "1. Add New Doctor\n";
@@ -137,42 +129,41 @@ static void executeQuery(const string &query,
 //        cout << "7. Print Doctor Info (Doctor ID)\n";
 //        cout << "8. Print Appointment Info (Appointment ID)\n";
 //        cout << "9. Write Query\n";
+//        cout << "I. Bulk Import (file)\n";
 //        cout << "E. Exit\n";
 //        cout << "Choose: ";
 //        string choice; cin >> choice;
 //
 //        if(choice == "1"){
-//            addDoctor(doctorPrimary, doctorSecondary, doctorAvail);
+//            addDoctor(doctorPrimary, doctorSecondary);
 //        } else if(choice == "2"){
-//            addAppointment(apptPrimary, apptSecondary, apptAvail, doctorPrimary);
+//            addAppointment(apptPrimary, apptSecondary, doctorPrimary);
 //        } else if(choice == "3"){
 //            updateDoctor(doctorPrimary, doctorSecondary);
 //        } else if(choice == "4"){
 //            updateAppointment(apptPrimary, apptSecondary, doctorPrimary);
 //        } else if(choice == "5"){
 //            char id[15]; cout << "Enter Appointment ID to delete: "; cin >> id;
-//            bool ok = deleteAppointmentByID(id, apptPrimary, apptSecondary, apptAvail);
+//            bool ok = deleteAppointmentByID(id, apptPrimary, apptSecondary);
 //            cout << (ok ? "Deleted\n" : "Not found or already deleted\n");
 //        } else if(choice == "6"){
 //            char id[15]; cout << "Enter Doctor ID to delete: "; cin >> id;
-//            bool ok = deleteDoctorByID(id, doctorPrimary, doctorSecondary, doctorAvail,
-//                                       apptPrimary, apptSecondary, apptAvail);
+//            bool ok = deleteDoctorByID(id, doctorPrimary, doctorSecondary,
+//                                       apptPrimary, apptSecondary);
 //            cout << (ok ? "Deleted\n" : "Not found or already deleted\n");
 //        } else if(choice == "7"){
 //            char id[15]; cout << "Enter Doctor ID: "; cin >> id;
 //            // First try to find the doctor in the primary index
 //            bool found = false;
-//            for (const auto &entry : doctorPrimary) {
-//                if (strcmp(entry.recordID, id) == 0) {
-//                    found = true;
-//                    string line = readLineAtOffset(doctorDataFile, entry.offset);
-//                    if(!line.empty() && line[0] != DELETE_FLAG) {
-//                        Doctor d = Doctor::fromLine(line);
-//                        cout << d;
-//                    } else {
-//                        cout << "Doctor " << id << " has been deleted\n";
-//                    }
-//                    break;
+//            long long off = getOffsetByID(openPrimaryIndex(doctorPrimaryIndexFile), id);
+//            if (off != -1) {
+//                found = true;
+//                string line = readLineAtOffset(doctorDataFile, off);
+//                if(!line.empty() && line[0] != DELETE_FLAG) {
+//                    Doctor d = Doctor::fromLine(line);
+//                    cout << d;
+//                } else {
+//                    cout << "Doctor " << id << " has been deleted\n";
 //                }
 //            }
 //            if (!found) {
@@ -182,22 +173,23 @@ static void executeQuery(const string &query,
 //            char id[15]; cout << "Enter Appointment ID: "; cin >> id;
 //            // First try to find the appointment in the primary index
 //            bool found = false;
-//            for (const auto &entry : apptPrimary) {
-//                if (strcmp(entry.recordID, id) == 0) {
-//                    found = true;
-//                    string line = readLineAtOffset(appointmentDataFile, entry.offset);
-//                    if(!line.empty() && line[0] != DELETE_FLAG) {
-//                        Appointment a = Appointment::fromLine(line);
-//                        cout << a;
-//                    } else {
-//                        cout << "Appointment " << id << " has been deleted\n";
-//                    }
-//                    break;
+//            long long off = getOffsetByID(openPrimaryIndex(appointmentPrimaryIndexFile), id);
+//            if (off != -1) {
+//                found = true;
+//                string line = readLineAtOffset(appointmentDataFile, off);
+//                if(!line.empty() && line[0] != DELETE_FLAG) {
+//                    Appointment a = Appointment::fromLine(line);
+//                    cout << a;
+//                } else {
+//                    cout << "Appointment " << id << " has been deleted\n";
 //                }
 //            }
 //            if (!found) {
 //                cout << "Appointment " << id << " not found\n";
 //            }
+//        } else if(choice == "I" || choice == "i"){
+//            string path; cout << "Enter import file: "; cin >> path;
+//            bulkImport(path, doctorPrimary, doctorSecondary, apptPrimary, apptSecondary);
 //        } else if(choice == "9"){
 //            cout << "Supported query examples:\n";
 //            cout << "  Select all from Doctors where Doctor ID='xxx';\n";
@@ -206,7 +198,8 @@ static void executeQuery(const string &query,
 //            cout << "Enter query: ";
 //            cin.ignore(numeric_limits<streamsize>::max(), '\n');
 //            string q; getline(cin, q);
-//            executeQuery(q, doctorPrimary, doctorSecondary, apptPrimary, apptSecondary);
+//            executeQuery(q, openPrimaryIndex(doctorPrimaryIndexFile), openSecondaryIndex(doctorSecondaryIndexFile),
+//                         openPrimaryIndex(appointmentPrimaryIndexFile), openSecondaryIndex(appointmentSecondaryIndexFile));
 //        } else if(choice == "E" || choice == "e"){
 //            break;
 //        } else {
@@ -1,4 +1,6 @@
 #include "creating_data_files.cpp"
+#include "../BuildABtree.cpp"
+#include "../Btree_Generic.cpp"
 #include <iostream>
 #include <fstream>
 #include <cstring>
@@ -6,10 +8,20 @@
 #include <algorithm>
 #include <string>
 #include <limits>
+#include <string_view>
+#include <set>
+#include <unordered_set>
 
 using namespace std;
 
+// Every record starts with one status byte, so a delete overwrites that byte
+// in place. Lines written before the status byte existed start with a digit.
 const char DELETE_FLAG = '*';
+const char ACTIVE_FLAG = ' ';
+
+static bool hasStatusByte(char c) {
+    return c == ACTIVE_FLAG || c == DELETE_FLAG;
+}
 
 /**
  * ===============================================================
@@ -30,29 +42,6 @@ static void readLineField(const char* prompt, char* dest, size_t size) {
     safe_strcpy(dest, input.c_str(), size);
 }
 
-// Returns how many usable characters a slot currently stores after stripping delete flag.
-static size_t recordSlotCapacity(const vector<string> &lines, int rrn) {
-    if (rrn < 0 || rrn >= (int)lines.size()) return 0;
-    const string &line = lines[rrn];
-    if (line.empty()) return 0;
-    if (line[0] == DELETE_FLAG) return line.size() - 1; // ignore delete marker
-    return line.size();
-}
-
-// First-fit allocation strategy over the avail list.
-static int popFirstFitSlot(vector<int> &avail, const vector<string> &lines, size_t neededLen) {
-    for (size_t i = 0; i < avail.size(); ++i) {
-        int rrn = avail[i];
-        size_t capacity = recordSlotCapacity(lines, rrn);
-        if (capacity >= neededLen) {
-            int slot = rrn;
-            avail.erase(avail.begin() + (int)i);
-            return slot;
-        }
-    }
-    return -1;
-}
-
 /**
  * ===============================================================
  *  GENERAL Struct for Doctor and Appointment & GENERAL DELETE & SEARCH functions
@@ -84,8 +73,7 @@ struct Doctor {
     static Doctor fromLine(const string &line) {
         if (line.empty()) return Doctor();
 
-        bool isDeleted = (line[0] == DELETE_FLAG);
-        string content = isDeleted ? line.substr(1) : line;
+        string content = hasStatusByte(line[0]) ? line.substr(1) : line;
 
         auto fields = split(content);
 
@@ -97,7 +85,7 @@ struct Doctor {
 
     string toLine() const {
         string data = string(Name) + "|" + string(Specialty) + "|" + string(ID);
-        return to_string(data.length()) + "|" + data;
+        return string(1, ACTIVE_FLAG) + to_string(data.length()) + "|" + data;
     }
 
 
@@ -136,9 +124,8 @@ struct Appointment {
     static Appointment fromLine(const string &line) {
         if (line.empty()) return Appointment();
 
-        // Handle deleted records
-        bool isDeleted = (line[0] == DELETE_FLAG);
-        string content = isDeleted ? line.substr(1) : line;
+        // Skip the status byte (active or deleted)
+        string content = hasStatusByte(line[0]) ? line.substr(1) : line;
 
         auto fields = split(content);
         if (fields.size() < 4) return Appointment();
@@ -148,7 +135,7 @@ struct Appointment {
 
     string toLine() const {
         string data = string(ID) + "|" + string(DoctorID) + "|" + string(Date);
-        return to_string(data.length()) + "|" + data;
+        return string(1, ACTIVE_FLAG) + to_string(data.length()) + "|" + data;
     }
 
     bool isEmpty() const {
@@ -165,32 +152,226 @@ struct Appointment {
     }
 };
 
-static string readLineAtOffset(const string &fileName, long long offset) {
-    ifstream in(fileName, ios::binary);
-    if (!in.is_open()) return "";
-    in.seekg(offset);
-    string line;
-    getline(in, line);
-    return line;
+/**
+ * ===============================================================
+ *  MAPPED DATA FILES
+ *  Purpose: Records are read straight from the data file's mapping
+ *           (mapFile in creating_data_files.cpp), which is dropped
+ *           whenever this program writes the file.
+ * ===============================================================
+ */
+
+// The record starting at offset, without its line ending; empty if out of range
+static string_view recordAtOffset(const string &fileName, long long offset) {
+    const MappedFile &m = mapFile(fileName);
+    if (offset < 0 || (size_t)offset >= m.size) return {};
+    const char* begin = m.data + offset;
+    const char* end = (const char*)memchr(begin, '\n', m.size - (size_t)offset);
+    size_t len = end ? (size_t)(end - begin) : m.size - (size_t)offset;
+    if (len > 0 && begin[len - 1] == '\r') len--;
+    return string_view(begin, len);
+}
+
+// Splits "<status>len|a|b|c" into its three fields
+static bool splitRecord(string_view record, bool &deleted, string_view fields[3]) {
+    deleted = !record.empty() && record[0] == DELETE_FLAG;
+    if (!record.empty() && hasStatusByte(record[0])) record.remove_prefix(1);
+
+    size_t bar = record.find('|');          // skip the length field
+    if (bar == string_view::npos) return false;
+    record.remove_prefix(bar + 1);
+    for (int i = 0; i < 3; i++) {
+        bar = record.find('|');
+        if (i < 2 && bar == string_view::npos) return false;
+        fields[i] = record.substr(0, bar);
+        if (bar != string_view::npos) record.remove_prefix(bar + 1);
+    }
+    return true;
+}
+
+// -------------------- Record views (no copies, valid until the file is rewritten) --------------------
+struct DoctorView {
+    string_view Name;
+    string_view Specialty;
+    string_view ID;
+    bool deleted = false;
+
+    static DoctorView at(const string &fileName, long long offset) {
+        DoctorView v;
+        string_view f[3];
+        if (splitRecord(recordAtOffset(fileName, offset), v.deleted, f)) {
+            v.Name = f[0];
+            v.Specialty = f[1];
+            v.ID = f[2];
+        }
+        return v;
+    }
+
+    bool isEmpty() const { return Name.empty() && Specialty.empty() && ID.empty(); }
+    bool isActive() const { return !deleted && !isEmpty(); }
+
+    Doctor toDoctor() const {
+        return Doctor(string(Name).c_str(), string(Specialty).c_str(), string(ID).c_str());
+    }
+
+    friend ostream& operator<<(ostream &os, const DoctorView &d) {
+        if (d.isEmpty()) os << "Deleted or empty record\n";
+        else os << "Name: " << d.Name << " | Specialty: " << d.Specialty << " | ID: " << d.ID << "\n";
+        return os;
+    }
+};
+
+struct AppointmentView {
+    string_view ID;
+    string_view DoctorID;
+    string_view Date;
+    bool deleted = false;
+
+    static AppointmentView at(const string &fileName, long long offset) {
+        AppointmentView v;
+        string_view f[3];
+        if (splitRecord(recordAtOffset(fileName, offset), v.deleted, f)) {
+            v.ID = f[0];
+            v.DoctorID = f[1];
+            v.Date = f[2];
+        }
+        return v;
+    }
+
+    bool isEmpty() const { return ID.empty() && DoctorID.empty() && Date.empty(); }
+    bool isActive() const { return !deleted && !isEmpty(); }
+
+    Appointment toAppointment() const {
+        return Appointment(string(ID).c_str(), string(DoctorID).c_str(), string(Date).c_str());
+    }
+
+    friend ostream& operator<<(ostream &os, const AppointmentView &a) {
+        if (a.isEmpty()) os << "Deleted or empty record\n";
+        else os << "AppointmentID: " << a.ID << " | DoctorID: " << a.DoctorID << " | Date: " << a.Date << endl;
+        return os;
+    }
+};
+
+/**
+ * ===============================================================
+ *  B-TREE PRIMARY INDEX (optional mode)
+ *  Purpose: ID lookups go through an on-disk B-tree (the generic
+ *           engine in ../Btree_Generic.cpp) that maps the fixed-width
+ *           ID of every active record to its offset. Adds and deletes
+ *           cost O(log n) node writes and nothing is loaded at startup.
+ * ===============================================================
+ */
+
+typedef FixedKey<16> RecordKey;   // IDs are at most 15 characters
+
+const string doctorPrimaryBtreeFile = "DoctorPrimaryIndex.btree";
+const string appointmentPrimaryBtreeFile = "AppointmentPrimaryIndex.btree";
+
+bool btreePrimaryIndex = false;
+static bool primaryBtreesDropped = false;
+
+static const string& primaryBtreeFile(const string &dataFile) {
+    return dataFile == doctorDataFile ? doctorPrimaryBtreeFile : appointmentPrimaryBtreeFile;
+}
+
+static RecordKey recordKey(const char *id) {
+    return KeyTraits<RecordKey>::encode(id);
+}
+
+// Bulk-loads a new B-tree with the active entries of a primary index, which is
+// sorted by ID
+void buildPrimaryBtree(const vector<PrimaryIndex> &primary, const string &btreeFile) {
+    vector<pair<RecordKey, int64_t>> entries;
+    entries.reserve(primary.size());
+    for (const auto &entry : primary)
+        if (entry.recordID[0] != '*')
+            entries.push_back({recordKey(entry.recordID), entry.offset});
+    BulkLoadGenericIndex(btreeFile.c_str(), entries);
+}
+
+// false for a missing file or one in an older format
+static bool primaryBtreeReadable(const string &btreeFile) {
+    fstream file(btreeFile, ios::in | ios::binary);
+    GenericHeader header;
+    return file && readGenericHeader<RecordKey>(file, header);
+}
+
+// Turns the mode on or off. The B-tree files are kept between runs; a missing
+// or unreadable one is built from the primary index file.
+void useBtreePrimaryIndex(bool on) {
+    btreePrimaryIndex = on;
+    if (!on) return;
+    if (!primaryBtreeReadable(doctorPrimaryBtreeFile))
+        buildPrimaryBtree(readPrimaryIndex(doctorPrimaryIndexFile), doctorPrimaryBtreeFile);
+    if (!primaryBtreeReadable(appointmentPrimaryBtreeFile))
+        buildPrimaryBtree(readPrimaryIndex(appointmentPrimaryIndexFile), appointmentPrimaryBtreeFile);
+    primaryBtreesDropped = false;   // the next change made with the mode off drops them again
+}
+
+// A change made while the mode is off would leave the B-trees stale, so they
+// are deleted and rebuilt the next time the mode is turned on
+static bool primaryBtreeCurrent() {
+    if (btreePrimaryIndex) return true;
+    if (!primaryBtreesDropped) {
+        remove(doctorPrimaryBtreeFile.c_str());
+        remove(appointmentPrimaryBtreeFile.c_str());
+        primaryBtreesDropped = true;
+    }
+    return false;
+}
+
+static void btreeInsert(const string &dataFile, const char *id, long long offset) {
+    if (primaryBtreeCurrent())
+        InsertGenericRecord(primaryBtreeFile(dataFile).c_str(), recordKey(id), offset);
+}
+
+static void btreeErase(const string &dataFile, const char *id) {
+    if (primaryBtreeCurrent())
+        DeleteGenericRecord(primaryBtreeFile(dataFile).c_str(), recordKey(id));
+}
+
+/**
+ * ===============================================================
+ *  HASH PRIMARY INDEX (optional mode)
+ *  Purpose: exact-match ID lookups through the Robin Hood table in
+ *           creating_data_files.cpp. While a hash file exists it is
+ *           kept current on every add, move and delete, so turning
+ *           the mode on never needs a rebuild.
+ * ===============================================================
+ */
+
+static const string& primaryHashFile(const string &dataFile) {
+    return dataFile == doctorDataFile ? doctorPrimaryHashFile : appointmentPrimaryHashFile;
+}
+
+// Turns the mode on or off; a missing hash file is built from the primary index file
+void useHashPrimaryIndex(bool on) {
+    hashPrimaryIndex = on;
+    if (!on) return;
+    if (!ifstream(doctorPrimaryHashFile))
+        buildHashIndex(readPrimaryIndex(doctorPrimaryIndexFile), doctorPrimaryHashFile);
+    if (!ifstream(appointmentPrimaryHashFile))
+        buildHashIndex(readPrimaryIndex(appointmentPrimaryIndexFile), appointmentPrimaryHashFile);
 }
 
 // Offset-based helpers
-long long getOffsetByID(const vector<PrimaryIndex> &primaryIndex, const char *id) {
+long long getOffsetByID(EntrySpan<PrimaryIndex> primaryIndex, const char *id) {
     int left = 0;
     int right = (int)primaryIndex.size() - 1;
 
+    // the index is sorted ignoring '*', with the active entry first
     while (left <= right) {
         int mid = left + (right - left) / 2;
-        int cmp = strcmp(id, primaryIndex[mid].recordID);
-        if (cmp == 0) return primaryIndex[mid].offset;
-        if (cmp < 0) right = mid - 1; else left = mid + 1;
+        int cmp = strcmp(id, unmarked(primaryIndex[mid].recordID));
+        if (cmp == 0 && primaryIndex[mid].recordID[0] != '*') return primaryIndex[mid].offset;
+        if (cmp <= 0) right = mid - 1; else left = mid + 1;
     }
     return -1;
 }
 
 //// ===================== SEARCH FUNCTIONS =====================
 
-vector<string> getAllIDsByKey(const vector<SecondaryIndex>& secondary, const char* key) {
+vector<string> getAllIDsByKey(EntrySpan<SecondaryIndex> secondary, const char* key) {
     vector<string> ids;
     string keyStr(key);
 
@@ -201,7 +382,7 @@ vector<string> getAllIDsByKey(const vector<SecondaryIndex>& secondary, const cha
 
     while (low <= high) {
         int mid = low + (high - low) / 2;
-        int cmp = strcmp(secondary[mid].keyValue, key);
+        int cmp = strcmp(unmarked(secondary[mid].keyValue), key);  // sorted ignoring '*'
 
         if (cmp == 0) {
             first = mid;
@@ -218,9 +399,9 @@ vector<string> getAllIDsByKey(const vector<SecondaryIndex>& secondary, const cha
     }
 
     // Collect all consecutive entries with the same key
-    for (int i = first; i < (int)secondary.size() && strcmp(secondary[i].keyValue, key) == 0; i++) {
+    for (int i = first; i < (int)secondary.size() && strcmp(unmarked(secondary[i].keyValue), key) == 0; i++) {
         // Skip deleted entries
-        if (secondary[i].linkedID[0] == '*') {
+        if (secondary[i].keyValue[0] == '*' || secondary[i].linkedID[0] == '*') {
             continue;
         }
 
@@ -233,9 +414,28 @@ vector<string> getAllIDsByKey(const vector<SecondaryIndex>& secondary, const cha
     return ids;
 }
 
-long long resolveActiveOffsetForID(const vector<PrimaryIndex> &primaryIndex,
+// True when the record at `offset` is active and carries `id`; a slot that was
+// freed and then reused by another record fails the check
+static bool activeRecordHasID(const string &dataFile, long long offset, const char *id) {
+    bool deleted = false;
+    string_view f[3];
+    if (!splitRecord(recordAtOffset(dataFile, offset), deleted, f) || deleted) return false;
+    string_view recordID = dataFile == doctorDataFile ? f[2] : f[0];
+    return recordID == id;
+}
+
+long long resolveActiveOffsetForID(EntrySpan<PrimaryIndex> primaryIndex,
                                    const string &dataFile,
                                    const char *id) {
+    // the hash and B-tree indexes only hold active records; the record is checked anyway
+    long long off = -1;
+    bool indexed = hashPrimaryIndex && hashLookup(primaryHashFile(dataFile), id, off);
+    if (!indexed && btreePrimaryIndex) {
+        off = SearchGenericRecord(primaryBtreeFile(dataFile).c_str(), recordKey(id));
+        indexed = true;
+    }
+    if (indexed) return off != -1 && activeRecordHasID(dataFile, off, id) ? off : -1;
+
     int left = 0;
     int right = (int)primaryIndex.size() - 1;
     int first = -1;
@@ -248,93 +448,405 @@ long long resolveActiveOffsetForID(const vector<PrimaryIndex> &primaryIndex,
         else if (cmp < 0) right = mid - 1; else left = mid + 1;
     }
     if (first == -1) return -1;
+    // a '*' entry points at where a deleted record used to be; that slot may
+    // hold another record by now, so only active entries are followed
     for (int i = first; i < (int)primaryIndex.size(); ++i) {
         const char* idx = primaryIndex[i].recordID;
         const char* cmpID = (idx[0] == '*') ? idx + 1 : idx;
         if (strcmp(id, cmpID) != 0) break;
+        if (idx[0] == '*') continue;
         long long off = primaryIndex[i].offset;
-        string line = readLineAtOffset(dataFile, off);
-        if (!line.empty() && line[0] != DELETE_FLAG) {
-            return off;
-        }
+        if (activeRecordHasID(dataFile, off, id)) return off;
     }
     return -1;
 }
 
-//// ===================== FILE UTILITIES =====================
-vector<string> readAllLines(const string &fileName) {
-    vector<string> lines;
-    ifstream in(fileName);
-    string line;
+// The same lookups over a mapped index view: only the entries for the ID or
+// key are gathered, then searched like an in-memory index
+long long getOffsetByID(const PrimaryIndexView &view, const char *id) {
+    return getOffsetByID(primaryEntriesFor(view, id), id);
+}
 
-    if (!in.is_open()) {
-        cout << "Could not open " << fileName << " for reading\n";
-        return lines;
-    }
+vector<string> getAllIDsByKey(const SecondaryIndexView &view, const char *key) {
+    return getAllIDsByKey(secondaryEntriesFor(view, key), key);
+}
 
-    while (getline(in, line)) {
-        lines.push_back(line);
-    }
-    in.close();
+long long resolveActiveOffsetForID(const PrimaryIndexView &view, const string &dataFile, const char *id) {
+    return resolveActiveOffsetForID(primaryEntriesFor(view, id), dataFile, id);
+}
+
+//// ===================== SLOT DIRECTORY =====================
+// One fixed-size entry per line of a data file (RRN = line number), kept in
+// "<data file>.slots" and updated by every write below, so an RRN gives its
+// offset and an offset its RRN without reading the data file. The header
+// holds the data file's size; a directory that does not match it is rebuilt
+// with one scan. Writes that keep the size (a slot reused, a delete, two free
+// slots merged) set the header's dirty flag before touching the data file and
+// clear it once their entries are written, so a crash in between also leads
+// to a rebuild.
+//
+// The deleted slots double as the avail list: they are kept in an ordered set
+// by capacity for best-fit reuse, and a slot freed next to another free slot
+// is merged with it (see SINGLE-BYTE DELETES). A line merged into the one
+// before it keeps its entry, marked MERGED_SLOT, so later RRNs do not change.
+
+const char MERGED_SLOT = '+';
+
+struct SlotEntry {
+    int32_t offset;     // first byte of the line
+    int32_t length;     // bytes of the record, without padding; for a
+                        // MERGED_SLOT, the RRN of the slot it joined
+    int32_t capacity;   // bytes of the line, without its newline
+    char status;        // ACTIVE_FLAG, DELETE_FLAG or MERGED_SLOT
+    char reserved[3];
+};
+
+struct SlotFileHeader {
+    char magic[4];      // "SDIR"
+    uint32_t version;
+    uint32_t count;
+    uint32_t dirty;     // 1 while the data file may be ahead of the entries
+    int64_t dataSize;   // size of the data file the entries describe
+};
+
+struct SlotDirectory {
+    vector<SlotEntry> slots;                // by RRN
+    unordered_map<long long, int> rrnOf;    // offset -> RRN
+    set<pair<int32_t, int>> freeSlots;      // (capacity, RRN) of deleted slots
+    int64_t dataSize = 0;
+    int updating = 0;                       // open SlotUpdate scopes
+    bool stale = false;                     // an update failed part way; stays dirty
+};
+
+const uint32_t slotFormatVersion = 1;
+const char slotDirectoryMagic[4] = {'S', 'D', 'I', 'R'};
+
+static unordered_map<string, SlotDirectory> slotDirectories;
+
+static string slotDirectoryFile(const string &dataFile) {
+    return dataFile + ".slots";
+}
+
+// Record length without the '|' and spaces padRecord adds
+static int32_t unpaddedLength(string_view record) {
+    size_t last = record.find_last_not_of(' ');
+    if (last != string_view::npos && record[last] == '|') return (int32_t)last;
+    return (int32_t)record.size();
+}
 
-    return lines;
+static SlotEntry slotFor(string_view record, long long offset) {
+    SlotEntry slot;
+    memset(&slot, 0, sizeof(slot));
+    slot.offset = (int32_t)offset;
+    slot.length = unpaddedLength(record);
+    slot.capacity = (int32_t)record.size();
+    slot.status = !record.empty() && record[0] == DELETE_FLAG ? DELETE_FLAG : ACTIVE_FLAG;
+    return slot;
 }
 
-void writeAllLines(const string &fileName, const vector<string> &lines) {
-    ofstream out(fileName, ios::binary);  // Open in binary mode to prevent newline conversion
-    if (!out.is_open()) {
-        cout << "ERROR - Could not open " << fileName << " for writing\n";
-        return;
+static SlotFileHeader slotHeader(const SlotDirectory &dir) {
+    SlotFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, slotDirectoryMagic, 4);
+    h.version = slotFormatVersion;
+    h.count = (uint32_t)dir.slots.size();
+    h.dirty = dir.updating > 0 || dir.stale;
+    h.dataSize = dir.dataSize;
+    return h;
+}
+
+static void saveSlotDirectory(const string &dataFile, const SlotDirectory &dir) {
+    SlotFileHeader h = slotHeader(dir);
+    ofstream out(slotDirectoryFile(dataFile), ios::binary | ios::trunc);
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)dir.slots.data(), (streamsize)(dir.slots.size() * sizeof(SlotEntry)));
+}
+
+// Writes one entry and the header through to the directory file
+static bool saveSlot(const string &dataFile, const SlotDirectory &dir, int rrn) {
+    int fd = open(slotDirectoryFile(dataFile).c_str(), O_WRONLY);
+    if (fd == -1) return false;
+    SlotFileHeader h = slotHeader(dir);
+    off_t at = (off_t)(sizeof(SlotFileHeader) + (size_t)rrn * sizeof(SlotEntry));
+    bool ok = pwrite(fd, &dir.slots[rrn], sizeof(SlotEntry), at) == (ssize_t)sizeof(SlotEntry)
+           && pwrite(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h);
+    close(fd);
+    return ok;
+}
+
+static bool saveSlotHeader(const string &dataFile, const SlotDirectory &dir) {
+    int fd = open(slotDirectoryFile(dataFile).c_str(), O_WRONLY);
+    if (fd == -1) return false;
+    SlotFileHeader h = slotHeader(dir);
+    bool ok = pwrite(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h);
+    close(fd);
+    return ok;
+}
+
+// Brackets an in-place change of the data file: the directory is marked dirty
+// on disk before the first byte changes and clean after the outermost scope
+// ends, unless a step failed (fail()), which keeps it dirty for good
+struct SlotUpdate {
+    const string &dataFile;
+    SlotDirectory &dir;
+    bool ok = false;
+
+    SlotUpdate(const string &file, SlotDirectory &d) : dataFile(file), dir(d) {
+        if (dir.updating++ == 0) ok = saveSlotHeader(dataFile, dir);
+        else ok = true;
     }
+    ~SlotUpdate() {
+        if (--dir.updating == 0) saveSlotHeader(dataFile, dir);
+    }
+    bool fail() {
+        dir.stale = true;
+        return false;
+    }
+};
 
-    for (size_t i = 0; i < lines.size(); ++i) {
-        out << lines[i];
-        // Only add newline if it's not the last line
-        if (i != lines.size() - 1) {
-            out << "\n";
+// The directory of a data file: loaded once, rebuilt if missing or stale
+static SlotDirectory& slotDirectory(const string &dataFile) {
+    auto it = slotDirectories.find(dataFile);
+    if (it != slotDirectories.end()) return it->second;
+
+    SlotDirectory &dir = slotDirectories[dataFile];
+    const MappedFile &m = mapFile(dataFile);
+    ifstream in(slotDirectoryFile(dataFile), ios::binary);
+    SlotFileHeader h;
+    bool loaded = false;
+    if (in.read((char*)&h, sizeof(h)) && memcmp(h.magic, slotDirectoryMagic, 4) == 0 &&
+        h.version == slotFormatVersion && !h.dirty && h.dataSize == (int64_t)m.size) {
+        dir.slots.resize(h.count);
+        loaded = (bool)in.read((char*)dir.slots.data(), (streamsize)(h.count * sizeof(SlotEntry)));
+    }
+    in.close();
+    dir.dataSize = h.dataSize;
+
+    if (!loaded) {
+        dir.slots.clear();
+        size_t pos = 0;
+        while (pos < m.size) {
+            dir.slots.push_back(slotFor(recordAtOffset(dataFile, (long long)pos), (long long)pos));
+            const char* nl = (const char*)memchr(m.data + pos, '\n', m.size - pos);
+            pos = nl ? (size_t)(nl - m.data) + 1 : m.size;
         }
+        dir.dataSize = (int64_t)m.size;
+        saveSlotDirectory(dataFile, dir);
+    }
+    dir.rrnOf.reserve(dir.slots.size());
+    for (int i = 0; i < (int)dir.slots.size(); ++i) {
+        const SlotEntry &slot = dir.slots[i];
+        if (slot.status == MERGED_SLOT) continue;
+        dir.rrnOf[slot.offset] = i;
+        if (slot.status == DELETE_FLAG && slot.capacity > 0) dir.freeSlots.insert({slot.capacity, i});
     }
-    out.close();
+    return dir;
 }
 
+// RRN of the record starting at offset, -1 if no line starts there
+static int rrnAtOffset(const string &fileName, long long offset) {
+    const SlotDirectory &dir = slotDirectory(fileName);
+    auto it = dir.rrnOf.find(offset);
+    return it == dir.rrnOf.end() ? -1 : it->second;
+}
 
-// Map an offset back to line index (RRN) by cumulative lengths
-static int rrnFromOffset(const vector<string> &lines, long long off){
-    long long cur = 0;
-    for(int i=0;i<(int)lines.size();++i){
-        if(cur == off) return i;
-        cur += (long long)lines[i].length() + 1;
-    }
-    return -1;
+// Bytes the line at offset takes, its newline included, as the index rebuild
+// counts them: a record written into a slot is padded to the slot's capacity
+static int recordLengthAt(const string &fileName, long long offset) {
+    int rrn = rrnAtOffset(fileName, offset);
+    return rrn == -1 ? 0 : slotDirectory(fileName).slots[rrn].capacity + 1;
 }
 
-// Build avail list (RRNs of deleted records) by scanning the data file
-static vector<int> buildAvailRRNsFromFile(const string &fileName) {
-    vector<int> avail;
-    vector<string> lines = readAllLines(fileName);
-    for (int i = 0; i < (int)lines.size(); ++i) {
-        if (!lines[i].empty() && lines[i][0] == DELETE_FLAG) {
-            avail.push_back(i);
-        }
-    }
-    sort(avail.begin(), avail.end());
-    return avail;
+// Offset of the line with this RRN, -1 if there is none
+static long long offsetOfRRN(const string &fileName, int rrn) {
+    const SlotDirectory &dir = slotDirectory(fileName);
+    if (rrn < 0 || rrn >= (int)dir.slots.size() || dir.slots[rrn].status == MERGED_SLOT) return -1;
+    return dir.slots[rrn].offset;
+}
+
+// Best fit: the smallest deleted slot that can hold neededLen bytes, -1 if none
+static int bestFitSlot(const string &fileName, size_t neededLen) {
+    const SlotDirectory &dir = slotDirectory(fileName);
+    auto it = dir.freeSlots.lower_bound({(int32_t)neededLen, -1});
+    return it == dir.freeSlots.end() ? -1 : it->second;
+}
+
+//// ===================== IN-PLACE SLOT WRITES =====================
+// Records are written where they live: a reused slot is overwritten and
+// padded to its old length, a new record is appended at the end, so the
+// offsets of all the other records stay the same.
+
+// Pads a record to exactly `capacity` bytes: an extra '|' ends the last field
+// and spaces fill the rest, so readers that split on '|' ignore the padding
+static string padRecord(const string &record, size_t capacity) {
+    if (record.size() >= capacity) return record;
+    return record + "|" + string(capacity - record.size() - 1, ' ');
+}
+
+// A MAP_SHARED mapping already sees what pwrite puts inside it, so the mapping
+// is only dropped when the write reaches past its end
+static bool writeRecordAt(const string &fileName, long long offset, const string &bytes) {
+    auto mapped = mappedFiles.find(fileName);
+    if (mapped != mappedFiles.end() && (size_t)offset + bytes.size() > mapped->second.size) unmapFile(fileName);
+    int fd = open(fileName.c_str(), O_WRONLY);
+    if (fd == -1) return false;
+    ssize_t written = pwrite(fd, bytes.data(), bytes.size(), (off_t)offset);
+    close(fd);
+    return written == (ssize_t)bytes.size();
+}
+
+// Appends a record as a new line and gives it the next RRN; returns its
+// offset, -1 on error
+static long long appendRecord(const string &fileName, const string &record) {
+    SlotDirectory &dir = slotDirectory(fileName);
+    unmapFile(fileName);
+    int fd = open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return -1; }
+
+    long long offset = st.st_size;
+    string bytes = record + "\n";
+    char last = '\n';
+    if (offset > 0 && pread(fd, &last, 1, (off_t)(offset - 1)) == 1 && last != '\n') {
+        bytes = "\n" + bytes;   // the last line was written without its newline
+        offset++;
+    }
+    ssize_t written = pwrite(fd, bytes.data(), bytes.size(), (off_t)st.st_size);
+    close(fd);
+    if (written != (ssize_t)bytes.size()) return -1;
+
+    dir.slots.push_back(slotFor(record, offset));
+    dir.rrnOf[offset] = (int)dir.slots.size() - 1;
+    dir.dataSize = (int64_t)st.st_size + (int64_t)bytes.size();
+    saveSlot(fileName, dir, (int)dir.slots.size() - 1);
+    return offset;
+}
+
+// Overwrites the record in slot rrn, padded to the slot's capacity
+static bool writeRecordInSlot(const string &fileName, int rrn, const string &record) {
+    SlotDirectory &dir = slotDirectory(fileName);
+    if (rrn < 0 || rrn >= (int)dir.slots.size()) return false;
+    SlotEntry &slot = dir.slots[rrn];
+    if (slot.status == MERGED_SLOT || (int32_t)record.size() > slot.capacity) return false;
+    SlotUpdate update(fileName, dir);
+    if (!update.ok || !writeRecordAt(fileName, slot.offset, padRecord(record, (size_t)slot.capacity))) return false;
+    if (slot.status == DELETE_FLAG) dir.freeSlots.erase({slot.capacity, rrn});
+    slot.length = (int32_t)record.size();
+    slot.status = ACTIVE_FLAG;
+    return saveSlot(fileName, dir, rrn) || update.fail();
+}
+
+//// ===================== SINGLE-BYTE DELETES =====================
+// Two free slots next to each other become one: the newline between them is
+// overwritten with '|', so the joined line still reads as the first (deleted)
+// record with the rest as padding, and a later record can use all of it.
+static bool mergeFreeSlots(const string &fileName, SlotDirectory &dir, int first, int second) {
+    SlotEntry &a = dir.slots[first];
+    SlotEntry &b = dir.slots[second];
+    SlotUpdate update(fileName, dir);
+    if (!update.ok || !writeRecordAt(fileName, (long long)a.offset + a.capacity, "|")) return false;
+    dir.freeSlots.erase({a.capacity, first});
+    dir.freeSlots.erase({b.capacity, second});
+    dir.rrnOf.erase(b.offset);
+    a.capacity += 1 + b.capacity;
+    b.status = MERGED_SLOT;
+    b.length = first;
+    dir.freeSlots.insert({a.capacity, first});
+    return (saveSlot(fileName, dir, second) && saveSlot(fileName, dir, first)) || update.fail();
+}
+
+// The slot holding rrn: itself, or the slot its line was merged into
+static int owningSlot(const SlotDirectory &dir, int rrn) {
+    while (rrn >= 0 && dir.slots[rrn].status == MERGED_SLOT) rrn = dir.slots[rrn].length;
+    return rrn;
 }
 
-static bool prependDeleteFlagAtOffset(const string &fileName, long long offset) {
-    vector<string> lines = readAllLines(fileName);
-    int rrn = rrnFromOffset(lines, offset);
+// Overwrites the status byte of the record at offset and frees its slot,
+// merging it with a free slot on either side; false if it is already deleted
+static bool markDeletedAtOffset(const string &fileName, long long offset) {
+    int rrn = rrnAtOffset(fileName, offset);
     if (rrn == -1) return false;
-    if (!lines[rrn].empty() && lines[rrn][0] == DELETE_FLAG) return false;
-    lines[rrn] = string(1, DELETE_FLAG) + lines[rrn];
-    writeAllLines(fileName, lines);
+    SlotDirectory &dir = slotDirectory(fileName);
+    if (dir.slots[rrn].capacity == 0 || dir.slots[rrn].status == DELETE_FLAG) return false;
+    SlotUpdate update(fileName, dir);   // covers the merges below too
+    if (!update.ok || !writeRecordAt(fileName, offset, string(1, DELETE_FLAG))) return false;
+    dir.slots[rrn].status = DELETE_FLAG;
+    dir.freeSlots.insert({dir.slots[rrn].capacity, rrn});
+    if (!saveSlot(fileName, dir, rrn)) return update.fail();
+
+    // lines end in a single '\n' here, so the next line starts right after it
+    auto next = dir.rrnOf.find((long long)dir.slots[rrn].offset + dir.slots[rrn].capacity + 1);
+    if (next != dir.rrnOf.end() && dir.slots[next->second].status == DELETE_FLAG)
+        mergeFreeSlots(fileName, dir, rrn, next->second);
+    int previous = owningSlot(dir, rrn - 1);
+    if (previous != -1 && dir.slots[previous].status == DELETE_FLAG &&
+        (long long)dir.slots[previous].offset + dir.slots[previous].capacity + 1 == offset)
+        mergeFreeSlots(fileName, dir, previous, rrn);
     return true;
 }
 
+// Deletes the record at offset: one byte in the data file (two when its slot
+// joins a free neighbour), then the in-memory indexes through the delta log.
+// Nothing else moves, so no index rebuild is needed.
+static bool tombstoneRecord(const string &dataFile, long long offset,
+                            const char *id, const char *secondaryKey,
+                            vector<PrimaryIndex> &primary, const string &primaryIndexFile,
+                            vector<SecondaryIndex> &secondary, const string &secondaryIndexFile) {
+    if (!markDeletedAtOffset(dataFile, offset)) return false;
+
+    string deletedID = string(1, DELETE_FLAG) + id;
+    int length = 0;   // the tombstone keeps the length of the line it marks
+    if (removePrimaryEntry(primary, primaryIndexFile, id, offset, &length))
+        addPrimaryEntry(primary, primaryIndexFile, deletedID.c_str(), offset, length);
+    btreeErase(dataFile, id);
+    hashErase(primaryHashFile(dataFile), id);
+    if (removeSecondaryEntry(secondary, secondaryIndexFile, secondaryKey, id))
+        addSecondaryEntry(secondary, secondaryIndexFile, secondaryKey, deletedID.c_str());
+    return true;
+}
+
+// Replaces the record at offset and returns where it lives now: in place when
+// the new record fits the old slot, otherwise the old slot is tombstoned and
+// the record appended (the old slot becomes free for the next add)
+static long long replaceRecordAt(const string &fileName, long long offset, const string &record) {
+    int rrn = rrnAtOffset(fileName, offset);
+    if (rrn == -1) return -1;
+    if ((int32_t)record.size() <= slotDirectory(fileName).slots[rrn].capacity)
+        return writeRecordInSlot(fileName, rrn, record) ? offset : -1;
+    if (!markDeletedAtOffset(fileName, offset)) return -1;
+    return appendRecord(fileName, record);
+}
+
+// Index changes after replaceRecordAt. A record that moved leaves its old slot
+// behind as a deleted entry, the same as a delete followed by an add.
+static void reindexReplacedRecord(const string &dataFile, const char *id,
+                                  long long offset, long long newOffset,
+                                  const char *oldKey, const char *newKey,
+                                  vector<PrimaryIndex> &primary, const string &primaryIndexFile,
+                                  vector<SecondaryIndex> &secondary, const string &secondaryIndexFile) {
+    string deletedID = string(1, DELETE_FLAG) + id;
+    if (newOffset != offset) {
+        int length = 0;
+        if (removePrimaryEntry(primary, primaryIndexFile, id, offset, &length))
+            addPrimaryEntry(primary, primaryIndexFile, deletedID.c_str(), offset, length);
+        addPrimaryEntry(primary, primaryIndexFile, id, newOffset, recordLengthAt(dataFile, newOffset));
+        btreeErase(dataFile, id);
+        btreeInsert(dataFile, id, newOffset);
+        hashInsert(primaryHashFile(dataFile), id, newOffset);
+        if (removeSecondaryEntry(secondary, secondaryIndexFile, oldKey, id))
+            addSecondaryEntry(secondary, secondaryIndexFile, oldKey, deletedID.c_str());
+        addSecondaryEntry(secondary, secondaryIndexFile, newKey, id);
+    } else if (strcmp(oldKey, newKey) != 0) {
+        removeSecondaryEntry(secondary, secondaryIndexFile, oldKey, id);
+        addSecondaryEntry(secondary, secondaryIndexFile, newKey, id);
+    }
+}
+
 //// ===================== APPOINTMENT OPERATIONS =====================
 vector<Appointment> searchAppointmentsByDoctorID(const char *doctorID,
-                                                 const vector<PrimaryIndex> &apptPrimary,
-                                                 const vector<SecondaryIndex> &apptSecondary) {
+                                                 const PrimaryIndexView &apptPrimary,
+                                                 const SecondaryIndexView &apptSecondary) {
     vector<Appointment> appointments;
     vector<string> apptIDs = getAllIDsByKey(apptSecondary, doctorID);
 
@@ -343,13 +855,10 @@ vector<Appointment> searchAppointmentsByDoctorID(const char *doctorID,
 
 
     for (auto &apptID : apptIDs) {
-        long long off = getOffsetByID(apptPrimary, apptID.c_str());
+        long long off = resolveActiveOffsetForID(apptPrimary, appointmentDataFile, apptID.c_str());
         if (off != -1) {
-            string line = readLineAtOffset(appointmentDataFile, off);
-            if (!line.empty() && line[0] != DELETE_FLAG) {
-                Appointment appt = Appointment::fromLine(line);
-                if (!appt.isEmpty()) appointments.push_back(appt);
-            }
+            AppointmentView appt = AppointmentView::at(appointmentDataFile, off);
+            if (appt.isActive()) appointments.push_back(appt.toAppointment());
         }
     }
 
@@ -358,173 +867,29 @@ vector<Appointment> searchAppointmentsByDoctorID(const char *doctorID,
 
 bool deleteAppointmentByID(const char *id,
                            vector<PrimaryIndex> &primary,
-                           vector<SecondaryIndex> &secondary,
-                           vector<int> &avail) {
-    // Refresh the primary index to get the most current data
-    primary = readPrimaryIndex(appointmentPrimaryIndexFile);
-
-    // Find the offset of the record to delete
-    long long off = -1;
-    bool isDeletedInIndex = false;
-    char doctorID[15] = "";
-    
-    // First, try to find the appointment in the data file to get the doctor ID
-    ifstream dataFile(appointmentDataFile);
-    if (dataFile.is_open()) {
-        string line;
-        while (getline(dataFile, line)) {
-            if (!line.empty() && line[0] != DELETE_FLAG) {
-                Appointment appt = Appointment::fromLine(line);
-                if (strcmp(appt.ID, id) == 0) {
-                    strcpy(doctorID, appt.DoctorID);
-                    break;
-                }
-            }
-        }
-        dataFile.close();
-    }
-    
-    // Find the record in primary index
-    for (const auto &entry : primary) {
-        // Check for deleted entries in the index
-        if (entry.recordID[0] == '*') {
-            if (strcmp(entry.recordID + 1, id) == 0) {
-                isDeletedInIndex = true;
-                off = entry.offset;
-                break;
-            }
-        } else if (strcmp(entry.recordID, id) == 0) {
-            off = entry.offset;
-            break;
-        }
-    }
-    
+                           vector<SecondaryIndex> &secondary) {
+    long long off = resolveActiveOffsetForID(primary, appointmentDataFile, id);
     if (off == -1) {
-        cout << "Appointment " << id << " not found in primary index\n";
-        return false;
-    }
-
-    // Read the record to verify its current state
-    string line = readLineAtOffset(appointmentDataFile, off);
-    if (line.empty()) {
-        cout << "Error: Could not read appointment data at offset " << off << "\n";
-        return false;
-    }
-    
-    // Check if the record is already deleted in the data file
-    if (line[0] == DELETE_FLAG) {
-        // If it's deleted in the data file but not in the index, update the index
-        if (!isDeletedInIndex) {
-            for (auto &entry : primary) {
-                if (strcmp(entry.recordID, id) == 0) {
-                    string deletedID = string("*") + id;
-                    strcpy(entry.recordID, deletedID.c_str());
-                    writePrimaryIndex(primary, appointmentPrimaryIndexFile);
-                    break;
-                }
-            }
-        }
-        cout << "Appointment " << id << " is already deleted\n";
+        cout << "Appointment " << id << " not found or already deleted\n";
         return false;
     }
 
-    // Mark the record as deleted in the data file
-    if (!prependDeleteFlagAtOffset(appointmentDataFile, off)) {
+    string doctorID(AppointmentView::at(appointmentDataFile, off).DoctorID);
+    if (!tombstoneRecord(appointmentDataFile, off, id, doctorID.c_str(),
+                         primary, appointmentPrimaryIndexFile,
+                         secondary, appointmentSecondaryIndexFile)) {
         cout << "Failed to mark appointment as deleted in data file\n";
         return false;
     }
-    // Calculate RRN (Record Relative Number) for the deleted record
-    int rrn = -1;
-    vector<string> lines = readAllLines(appointmentDataFile);
-    long long currentOffset = 0;
-    for (int i = 0; i < (int)lines.size(); i++) {
-        if (currentOffset == off) {
-            rrn = i;
-            break;
-        }
-        currentOffset += (long long)lines[i].length() + 1; // +1 for newline
-    }
-
-    // Add the RRN to the available list if found
-    if (rrn != -1) {
-        // Check if this RRN is already in avail to avoid duplicates
-        if (find(avail.begin(), avail.end(), rrn) == avail.end()) {
-            avail.push_back(rrn);
-            sort(avail.begin(), avail.end()); // Keep the list sorted
-        }
-    }
 
-
-    // Update the primary index to mark this record as deleted
-    bool foundInPrimary = false;
-    for (auto &entry : primary) {
-        if (strcmp(entry.recordID, id) == 0) {
-            // Mark as deleted in primary index
-            string deletedID = string("*") + id;
-            strcpy(entry.recordID, deletedID.c_str());
-            foundInPrimary = true;
-            break;
-        }
-    }
-    
-    if (!foundInPrimary) {
-        // If not found in primary index, add it as deleted
-        PrimaryIndex p;
-        string deletedID = string("*") + id;
-        strcpy(p.recordID, deletedID.c_str());
-        p.offset = (int)off;
-        primary.push_back(p);
-        sort(primary.begin(), primary.end());
-    }
-    
-    // Update the secondary index to mark related entries as deleted
-    bool foundInSecondary = false;
-    for (auto &entry : secondary) {
-        if (strcmp(entry.linkedID, id) == 0) {
-            // Mark the linked ID as deleted
-            string deletedID = string("*") + id;
-            strcpy(entry.linkedID, deletedID.c_str());
-            foundInSecondary = true;
-        }
-    }
-    
-    // If not found in secondary index but we have the doctor ID, add it
-    if (!foundInSecondary && strlen(doctorID) > 0) {
-        SecondaryIndex s;
-        strcpy(s.keyValue, doctorID);
-        string deletedID = string("*") + id;
-        strcpy(s.linkedID, deletedID.c_str());
-        secondary.push_back(s);
-        sort(secondary.begin(), secondary.end());
-    }
-    
-    // Write the updated indexes
-    try {
-        writePrimaryIndex(primary, appointmentPrimaryIndexFile);
-        writeSecondaryIndex(secondary, appointmentSecondaryIndexFile);
-    } catch (const exception& e) {
-        cout << "Warning: Failed to write indexes - " << e.what() << "\n";
-        return false;
-    }
-    
-    // Rebuild indexes to ensure consistency
-    Build_indexes();
-    
-    // Refresh the primary and secondary indexes
-    primary = readPrimaryIndex(appointmentPrimaryIndexFile);
-    secondary = readSecondaryIndex(appointmentSecondaryIndexFile);
-    
     cout << "Successfully deleted appointment " << id << "\n";
     return true;
 }
 
+// Tombstones every appointment of the doctor: one byte and two index log entries each
 bool deleteAllAppointmentsForDoctor(const char *doctorID,
                                   vector<PrimaryIndex> &apptPrimary,
-                                  vector<SecondaryIndex> &apptSecondary,
-                                  vector<int> &apptAvail) {
-    // First, refresh the secondary index to get the most current data
-    apptSecondary = readSecondaryIndex(appointmentSecondaryIndexFile);
-
+                                  vector<SecondaryIndex> &apptSecondary) {
     // Get all appointment IDs for this doctor
     vector<string> apptIDs = getAllIDsByKey(apptSecondary, doctorID);
 
@@ -539,29 +904,17 @@ bool deleteAllAppointmentsForDoctor(const char *doctorID,
     int deletedCount = 0;
 
     for (auto &apptID : apptIDs) {
-        cout << "Processing appointment " << apptID << "...\n";
-
-        // Delete the appointment
-        bool success = deleteAppointmentByID(apptID.c_str(), apptPrimary, apptSecondary, apptAvail);
-
-        if (success) {
+        long long off = resolveActiveOffsetForID(apptPrimary, appointmentDataFile, apptID.c_str());
+        if (off != -1 && tombstoneRecord(appointmentDataFile, off, apptID.c_str(), doctorID,
+                                         apptPrimary, appointmentPrimaryIndexFile,
+                                         apptSecondary, appointmentSecondaryIndexFile)) {
             deletedCount++;
         } else {
             allDeleted = false;
             cout << "Failed to delete appointment " << apptID << " (it may have been already deleted)\n";
         }
-
-        // Refresh the secondary index after each deletion
-        apptSecondary = readSecondaryIndex(appointmentSecondaryIndexFile);
     }
 
-    // Rebuild indexes to ensure consistency
-    Build_indexes();
-
-    // Refresh the indexes one final time
-    apptPrimary = readPrimaryIndex(appointmentPrimaryIndexFile);
-    apptSecondary = readSecondaryIndex(appointmentSecondaryIndexFile);
-    
     cout << "Successfully deleted " << deletedCount << " appointment(s) for doctor " << doctorID << endl;
     return allDeleted;
 }
@@ -570,114 +923,27 @@ bool deleteAllAppointmentsForDoctor(const char *doctorID,
 bool deleteDoctorByID(const char *id,
                       vector<PrimaryIndex> &primary,
                       vector<SecondaryIndex> &secondary,
-                      vector<int> &avail,
                       vector<PrimaryIndex> &apptPrimary,
-                      vector<SecondaryIndex> &apptSecondary,
-                      vector<int> &apptAvail) {
-    // Find the doctor's offset
-    long long off = -1;
-    bool isDeletedInIndex = false;
-    
-    // First check if the ID exists in the primary index and get its offset
-    for (const auto &entry : primary) {
-        // Skip already deleted entries in the index
-        if (entry.recordID[0] == '*') {
-            if (strcmp(entry.recordID + 1, id) == 0) {
-                isDeletedInIndex = true;
-                off = entry.offset;
-                break;
-            }
-        } else if (strcmp(entry.recordID, id) == 0) {
-            off = entry.offset;
-            break;
-        }
-    }
-    
+                      vector<SecondaryIndex> &apptSecondary) {
+    long long off = resolveActiveOffsetForID(primary, doctorDataFile, id);
     if (off == -1) {
-        cout << "Doctor " << id << " not found\n";
-        return false;
-    }
-
-    // Read the record to verify its current state
-    string line = readLineAtOffset(doctorDataFile, off);
-    if (line.empty()) {
-        cout << "Error: Could not read doctor data\n";
-        return false;
-    }
-    
-    // Check if the record is already deleted in the data file
-    if (line[0] == DELETE_FLAG) {
-        // If it's deleted in the data file but not in the index, update the index
-        if (!isDeletedInIndex) {
-            for (auto &entry : primary) {
-                if (strcmp(entry.recordID, id) == 0) {
-                    string deletedID = string("*") + id;
-                    strcpy(entry.recordID, deletedID.c_str());
-                    writePrimaryIndex(primary, doctorPrimaryIndexFile);
-                    break;
-                }
-            }
-        }
-        cout << "Doctor " << id << " is already deleted\n";
+        cout << "Doctor " << id << " not found or already deleted\n";
         return false;
     }
 
     // First delete all appointments for this doctor
     cout << "Deleting all appointments for doctor " << id << "...\n";
-    deleteAllAppointmentsForDoctor(id, apptPrimary, apptSecondary, apptAvail);
+    deleteAllAppointmentsForDoctor(id, apptPrimary, apptSecondary);
+    markSecondaryKeyDeleted(apptSecondary, appointmentSecondaryIndexFile, id);
 
-    if (!prependDeleteFlagAtOffset(doctorDataFile, off)) {
+    string name(DoctorView::at(doctorDataFile, off).Name);
+    if (!tombstoneRecord(doctorDataFile, off, id, name.c_str(),
+                         primary, doctorPrimaryIndexFile,
+                         secondary, doctorSecondaryIndexFile)) {
         cout << "Failed to mark doctor as deleted in data file\n";
         return false;
     }
 
-    // Calculate RRN (Record Relative Number) for the deleted doctor record
-    int rrn = -1;
-    vector<string> lines = readAllLines(doctorDataFile);
-    long long currentOffset = 0;
-    for (int i = 0; i < (int)lines.size(); i++) {
-        if (currentOffset == off) {
-            rrn = i;
-            break;
-        }
-        currentOffset += (long long)lines[i].length() + 1; // +1 for newline
-    }
-
-    // Add the RRN to the available list if found
-    if (rrn != -1) {
-        // Check if this RRN is already in avail to avoid duplicates
-        if (find(avail.begin(), avail.end(), rrn) == avail.end()) {
-            avail.push_back(rrn);
-            sort(avail.begin(), avail.end()); // Keep the list sorted
-        }
-    }
-
-    // Update primary index to mark as deleted
-    for (auto &entry : primary) {
-        if (strcmp(entry.recordID, id) == 0) {
-            string deletedID = string("*") + id;
-            strcpy(entry.recordID, deletedID.c_str());
-            break;
-        }
-    }
-
-    // Update secondary index to mark as deleted
-    for (auto &entry : secondary) {
-        if (strcmp(entry.linkedID, id) == 0) {
-            string deletedID = string("*") + id;
-            strcpy(entry.linkedID, deletedID.c_str());
-        }
-    }
-
-    // Write updated indexes
-    writePrimaryIndex(primary, doctorPrimaryIndexFile);
-    writeSecondaryIndex(secondary, doctorSecondaryIndexFile);
-
-    Build_indexes();
-    primary = readPrimaryIndex(doctorPrimaryIndexFile);
-    secondary = readSecondaryIndex(doctorSecondaryIndexFile);
-    apptPrimary = readPrimaryIndex(appointmentPrimaryIndexFile);
-    apptSecondary = readSecondaryIndex(appointmentSecondaryIndexFile);
     cout << "Successfully deleted doctor " << id << " and all related appointments\n";
     return true;
 }
@@ -692,83 +958,51 @@ bool deleteDoctorByID(const char *id,
  */
 
 // ---------- Add New Doctor ----------
-bool addDoctor(vector<PrimaryIndex> &primary,vector<SecondaryIndex> &secondary,vector<int> &avail) {
+bool addDoctor(vector<PrimaryIndex> &primary,vector<SecondaryIndex> &secondary) {
     Doctor d;
     readLineField("Enter Doctor Name: ", d.Name, sizeof(d.Name));
     readLineField("Enter Specialty: ", d.Specialty, sizeof(d.Specialty));
     readLineField("Enter Doctor ID: ", d.ID, sizeof(d.ID));
 
-    // Refresh indexes and verify existence only if active (not deleted)
-    primary = readPrimaryIndex(doctorPrimaryIndexFile);
+    // Verify existence only if active (not deleted)
     long long eoff = resolveActiveOffsetForID(primary, doctorDataFile, d.ID);
     if (eoff != -1) {
         cout << "Doctor with this ID already exists.\n";
         return false;
     }
 
-    vector<string> lines = readAllLines(doctorDataFile);
+    // Reuse the smallest deleted slot that can hold the record, otherwise append it
     string newLine = d.toLine();
-    size_t neededLen = newLine.size();
-    int rrn = -1;
-
-    // Prefer filling a leading blank line (legacy data files sometimes start with an empty line).
-    if (!lines.empty() && lines[0].empty()) {
-        rrn = 0;
-        lines[0] = newLine;
+    long long offset = -1;
+    int rrn = bestFitSlot(doctorDataFile, newLine.size());
+    if (rrn != -1) {
+        if (writeRecordInSlot(doctorDataFile, rrn, newLine)) offset = offsetOfRRN(doctorDataFile, rrn);
     } else {
-        // Otherwise look for the first deleted slot that can fit this record.
-        int slot = popFirstFitSlot(avail, lines, neededLen);
-        if (slot != -1) {
-            rrn = slot;
-            if (rrn < (int)lines.size()) {
-                lines[rrn] = newLine;
-            } else {
-                while ((int)lines.size() <= rrn) lines.push_back("");
-                lines[rrn] = newLine;
-            }
-        } else {
-            rrn = (int)lines.size();
-            lines.push_back(newLine);
-        }
+        offset = appendRecord(doctorDataFile, newLine);
+    }
+    if (offset == -1) {
+        cout << "ERROR - Could not write " << doctorDataFile << "\n";
+        return false;
     }
 
-    // Write doctor record
-    writeAllLines(doctorDataFile, lines);
-
-    // Update primary index using offset
-    long long offset = 0;
-    for (int i = 0; i < rrn; ++i) offset += (long long)lines[i].length() + 1;
-    PrimaryIndex p;
-    safe_strcpy(p.recordID, d.ID, sizeof(p.recordID));
-    p.offset = (int)offset;
-    primary.push_back(p);
-    sort(primary.begin(), primary.end());
-    writePrimaryIndex(primary, doctorPrimaryIndexFile);
-
-    // Update secondary index
-    SecondaryIndex s;
-    safe_strcpy(s.keyValue, d.Name, sizeof(s.keyValue));
-    safe_strcpy(s.linkedID, d.ID, sizeof(s.linkedID));
-    secondary.push_back(s);
-    sort(secondary.begin(), secondary.end());
-    writeSecondaryIndex(secondary, doctorSecondaryIndexFile);
-
-    Build_indexes();
-    primary = readPrimaryIndex(doctorPrimaryIndexFile);
-    secondary = readSecondaryIndex(doctorSecondaryIndexFile);
+    // Update both indexes in place; the changes go to their delta logs
+    addPrimaryEntry(primary, doctorPrimaryIndexFile, d.ID, offset, recordLengthAt(doctorDataFile, offset));
+    btreeInsert(doctorDataFile, d.ID, offset);
+    hashInsert(doctorPrimaryHashFile, d.ID, offset);
+    addSecondaryEntry(secondary, doctorSecondaryIndexFile, d.Name, d.ID);
+
     cout << "Doctor added successfully" << endl;
     return true;
 }
 
 // ---------- Add New Appointment ----------
-bool addAppointment(vector<PrimaryIndex> &primary,vector<SecondaryIndex> &secondary,vector<int> &avail, const vector<PrimaryIndex> &doctorPrimary) {
+bool addAppointment(vector<PrimaryIndex> &primary,vector<SecondaryIndex> &secondary, const vector<PrimaryIndex> &doctorPrimary) {
     Appointment a;
     readLineField("Enter Appointment ID: ", a.ID, sizeof(a.ID));
     readLineField("Enter Doctor ID: ", a.DoctorID, sizeof(a.DoctorID));
     readLineField("Enter Date (no spaces): ", a.Date, sizeof(a.Date));
 
-    // Refresh and verify existence only if active (not deleted)
-    primary = readPrimaryIndex(appointmentPrimaryIndexFile);
+    // Verify existence only if active (not deleted)
     long long aoff = resolveActiveOffsetForID(primary, appointmentDataFile, a.ID);
     if (aoff != -1) {
         cout << "Appointment already exists.\n";
@@ -782,76 +1016,34 @@ bool addAppointment(vector<PrimaryIndex> &primary,vector<SecondaryIndex> &second
         return false;
     }
     {
-        string dline = readLineAtOffset(doctorDataFile, doff);
+        string_view dline = recordAtOffset(doctorDataFile, doff);
         if (dline.empty() || dline[0] == DELETE_FLAG) {
             cout << "Doctor record is deleted or invalid. Cannot add appointment.\n";
             return false;
         }
     }
 
-    vector<string> lines = readAllLines(appointmentDataFile);
+    // Apply best-fit policy on the free appointment slots, otherwise append
     string newLine = a.toLine();
-    size_t neededLen = newLine.size();
-    int rrn;
-    if (!lines.empty() && lines[0].empty()) {
-        rrn = 0;
-        lines[0] = newLine;
+    long long offset = -1;
+    int rrn = bestFitSlot(appointmentDataFile, newLine.size());
+    if (rrn != -1) {
+        if (writeRecordInSlot(appointmentDataFile, rrn, newLine)) offset = offsetOfRRN(appointmentDataFile, rrn);
     } else {
-        // Apply first-fit policy on appointment avail slots.
-        int slot = popFirstFitSlot(avail, lines, neededLen);
-        if (slot != -1) {
-            rrn = slot;
-            if (rrn < (int)lines.size()) {
-                lines[rrn] = newLine;
-            } else {
-                while ((int)lines.size() <= rrn) lines.push_back("");
-                lines[rrn] = newLine;
-            }
-        } else {
-            rrn = (int)lines.size();
-            lines.push_back(newLine);
-        }
+        offset = appendRecord(appointmentDataFile, newLine);
     }
-
-    writeAllLines(appointmentDataFile, lines);
-
-    long long offset = 0;
-    for (int i = 0; i < rrn; ++i) offset += (long long)lines[i].length() + 1;
-    PrimaryIndex p;
-    safe_strcpy(p.recordID, a.ID, sizeof(p.recordID));
-    p.offset = (int)offset;
-    primary.push_back(p);
-    sort(primary.begin(), primary.end());
-    writePrimaryIndex(primary, appointmentPrimaryIndexFile);
-
-    // Update secondary index for doctor ID
-    SecondaryIndex s;
-    safe_strcpy(s.keyValue, a.DoctorID, sizeof(s.keyValue));
-    safe_strcpy(s.linkedID, a.ID, sizeof(s.linkedID));
-
-    // Read current secondary index to avoid duplicates
-    secondary = readSecondaryIndex(appointmentSecondaryIndexFile);
-
-    // Check if this doctor-appointment mapping already exists
-    bool exists = false;
-    for (const auto& entry : secondary) {
-        if (strcmp(entry.keyValue, a.DoctorID) == 0 &&
-            strcmp(entry.linkedID, a.ID) == 0) {
-            exists = true;
-            break;
-        }
+    if (offset == -1) {
+        cout << "ERROR - Could not write " << appointmentDataFile << "\n";
+        return false;
     }
 
-    if (!exists) {
-        secondary.push_back(s);
-        sort(secondary.begin(), secondary.end());
-        writeSecondaryIndex(secondary, appointmentSecondaryIndexFile);
-    }
+    // The ID is not active in the primary index, so the doctor -> appointment
+    // mapping cannot exist yet either
+    addPrimaryEntry(primary, appointmentPrimaryIndexFile, a.ID, offset, recordLengthAt(appointmentDataFile, offset));
+    btreeInsert(appointmentDataFile, a.ID, offset);
+    hashInsert(appointmentPrimaryHashFile, a.ID, offset);
+    addSecondaryEntry(secondary, appointmentSecondaryIndexFile, a.DoctorID, a.ID);
 
-    // Keep all appointment-related indexes in sync just like doctor additions
-    Build_indexes();
-    primary = readPrimaryIndex(appointmentPrimaryIndexFile);
-    secondary = readSecondaryIndex(appointmentSecondaryIndexFile);
     cout << "Appointment added successfully" << endl;
     return true;
 }
@@ -868,14 +1060,14 @@ bool updateDoctor(vector<PrimaryIndex> &primary,vector<SecondaryIndex> &secondar
         return false;
     }
 
-    vector<string> lines = readAllLines(doctorDataFile);
-    int rrn = rrnFromOffset(lines, off);
-    if (rrn == -1 || lines[rrn].empty() || lines[rrn][0] == DELETE_FLAG) {
+    DoctorView current = DoctorView::at(doctorDataFile, off);
+    if (!current.isActive()) {
         cout << "Invalid or deleted record.\n";
         return false;
     }
 
-    Doctor d = Doctor::fromLine(lines[rrn]);
+    Doctor d = current.toDoctor();
+    string oldName = d.Name;
     cout << "Current: " << d;
 
     cout << "Enter new Name: ";
@@ -883,28 +1075,15 @@ bool updateDoctor(vector<PrimaryIndex> &primary,vector<SecondaryIndex> &secondar
     cout << "Enter new Specialty: ";
     cin >> d.Specialty;
 
-    lines[rrn] = d.toLine();
-
-
-    ofstream out(doctorDataFile);
-    for (auto &line : lines){
-        out << line << "\n";
-    }
-    out.close();
-
-    // Update secondary index -> Dr.Name
-    for (auto &s : secondary) {
-        if (strcmp(s.linkedID, id) == 0) {
-            safe_strcpy(s.keyValue, d.Name, sizeof(s.keyValue));
-        }
+    long long newOff = replaceRecordAt(doctorDataFile, off, d.toLine());
+    if (newOff == -1) {
+        cout << "ERROR - Could not write " << doctorDataFile << "\n";
+        return false;
     }
+    // Primary offset (if the record moved) and secondary index -> Dr.Name
+    reindexReplacedRecord(doctorDataFile, id, off, newOff, oldName.c_str(), d.Name,
+                          primary, doctorPrimaryIndexFile, secondary, doctorSecondaryIndexFile);
 
-    sort(secondary.begin(), secondary.end());
-    writeSecondaryIndex(secondary, doctorSecondaryIndexFile);
-
-    Build_indexes();
-    primary = readPrimaryIndex(doctorPrimaryIndexFile);
-    secondary = readSecondaryIndex(doctorSecondaryIndexFile);
     cout << "Doctor updated successfully.\n";
     return true;
 }
@@ -919,10 +1098,10 @@ bool updateAppointment(vector<PrimaryIndex> &primary,vector<SecondaryIndex> &sec
         return false;
     }
 
-    vector<string> lines = readAllLines(appointmentDataFile);
-    int rrn = rrnFromOffset(lines, off);
-    if (rrn == -1) { cout << "Invalid record position.\n"; return false; }
-    Appointment a = Appointment::fromLine(lines[rrn]);
+    AppointmentView current = AppointmentView::at(appointmentDataFile, off);
+    if (!current.isActive()) { cout << "Invalid record position.\n"; return false; }
+    Appointment a = current.toAppointment();
+    string oldDoctorID = a.DoctorID;
     cout << "Current: " << a;
     cout << "Enter new DoctorID: "; cin >> a.DoctorID;
     cout << "Enter new Date: "; cin >> a.Date;
@@ -934,27 +1113,226 @@ bool updateAppointment(vector<PrimaryIndex> &primary,vector<SecondaryIndex> &sec
         return false;
     }
     {
-        string dline = readLineAtOffset(doctorDataFile, doff);
+        string_view dline = recordAtOffset(doctorDataFile, doff);
         if (dline.empty() || dline[0] == DELETE_FLAG) {
             cout << "Doctor record is deleted or invalid. Update aborted.\n";
             return false;
         }
     }
 
-    lines[rrn] = a.toLine();
-    writeAllLines(appointmentDataFile, lines);
+    long long newOff = replaceRecordAt(appointmentDataFile, off, a.toLine());
+    if (newOff == -1) {
+        cout << "ERROR - Could not write " << appointmentDataFile << "\n";
+        return false;
+    }
+    // Primary offset (if the record moved) and secondary index (DoctorID)
+    reindexReplacedRecord(appointmentDataFile, id, off, newOff, oldDoctorID.c_str(), a.DoctorID,
+                          primary, appointmentPrimaryIndexFile, secondary, appointmentSecondaryIndexFile);
+
+    cout << "Appointment updated successfully.\n";
+    return true;
+}
+
+/**
+ * ===============================================================
+ *  BULK IMPORT
+ *  Purpose: Loads a large delimited file of doctors and appointments
+ *           in one streaming pass. Records are appended to the data
+ *           files sequentially, each appointment's DoctorID is checked
+ *           against a hash set built once, and the four indexes are
+ *           merged and written once at the end.
+ *
+ *  Input, one record per line ('#' comments and blank lines skipped):
+ *      D|Name|Specialty|DoctorID
+ *      A|AppointmentID|DoctorID|Date
+ *  A doctor must come before its appointments. Invalid lines are
+ *  reported and skipped.
+ * ===============================================================
+ */
+
+// One data file being appended to during an import
+struct ImportFile {
+    string dataFile;
+    ofstream out;
+    vector<char> buffer;
+    long long offset = 0;              // where the next line goes
+    vector<PrimaryIndex> primary;      // entries for the new records
+    vector<SecondaryIndex> secondary;
+
+    bool open(const string &fileName) {
+        dataFile = fileName;
+        slotDirectory(dataFile);       // loaded before the file changes
+        unmapFile(dataFile);
+
+        int fd = ::open(dataFile.c_str(), O_RDONLY | O_CREAT, 0644);
+        if (fd == -1) return false;
+        struct stat st;
+        char last = '\n';
+        if (fstat(fd, &st) == 0 && st.st_size > 0) pread(fd, &last, 1, (off_t)(st.st_size - 1));
+        close(fd);
+
+        buffer.resize(1 << 20);
+        out.rdbuf()->pubsetbuf(buffer.data(), (streamsize)buffer.size());
+        out.open(dataFile, ios::binary | ios::app);
+        offset = (long long)st.st_size;
+        if (last != '\n') {
+            out << '\n';               // the last line was written without its newline
+            offset++;
+        }
+        return (bool)out;
+    }
+
+    void add(const string &record, const char *id, const char *key) {
+        out << record << '\n';
 
-    // Update secondary index (DoctorID)
-    for (auto &s : secondary)
-        if (strcmp(s.linkedID, id) == 0)
-            safe_strcpy(s.keyValue, a.DoctorID, sizeof(s.keyValue));
+        SlotDirectory &dir = slotDirectory(dataFile);
+        dir.slots.push_back(slotFor(record, offset));
+        dir.rrnOf[offset] = (int)dir.slots.size() - 1;
 
-    sort(secondary.begin(), secondary.end());
-    writeSecondaryIndex(secondary, appointmentSecondaryIndexFile);
+        PrimaryIndex p;
+        safe_strcpy(p.recordID, id, sizeof(p.recordID));
+        p.offset = (int)offset;
+        p.recordLength = (int)record.size() + 1;
+        primary.push_back(p);
 
-    Build_indexes();
-    primary = readPrimaryIndex(appointmentPrimaryIndexFile);
-    secondary = readSecondaryIndex(appointmentSecondaryIndexFile);
-    cout << "Appointment updated successfully.\n";
+        SecondaryIndex s;
+        safe_strcpy(s.keyValue, key, sizeof(s.keyValue));
+        safe_strcpy(s.linkedID, id, sizeof(s.linkedID));
+        secondary.push_back(s);
+
+        offset += (long long)record.size() + 1;
+    }
+
+    // Flushes the data file, saves its slot directory and merges the new
+    // entries into the indexes, each written once
+    bool finish(vector<PrimaryIndex> &allPrimary, const string &primaryIndexFile,
+                vector<SecondaryIndex> &allSecondary, const string &secondaryIndexFile) {
+        out.close();
+        unmapFile(dataFile);
+        if (!out) return false;
+
+        SlotDirectory &dir = slotDirectory(dataFile);
+        dir.dataSize = offset;
+        saveSlotDirectory(dataFile, dir);
+
+        sort(primary.begin(), primary.end(), primaryEntryLess);
+        vector<PrimaryIndex> mergedPrimary;
+        mergedPrimary.reserve(allPrimary.size() + primary.size());
+        merge(allPrimary.begin(), allPrimary.end(), primary.begin(), primary.end(),
+              back_inserter(mergedPrimary), primaryEntryLess);
+        allPrimary.swap(mergedPrimary);
+        writePrimaryIndex(allPrimary, primaryIndexFile);
+
+        sort(secondary.begin(), secondary.end(), secondaryEntryLess);
+        vector<SecondaryIndex> mergedSecondary;
+        mergedSecondary.reserve(allSecondary.size() + secondary.size());
+        merge(allSecondary.begin(), allSecondary.end(), secondary.begin(), secondary.end(),
+              back_inserter(mergedSecondary), secondaryEntryLess);
+        allSecondary.swap(mergedSecondary);
+        writeSecondaryIndex(allSecondary, secondaryIndexFile);
+
+        // the optional B-tree and hash indexes are rebuilt once from the merged
+        // entries rather than taking the new IDs one by one
+        if (primaryBtreeCurrent())
+            buildPrimaryBtree(allPrimary, primaryBtreeFile(dataFile));
+        if (openHashIndex(primaryHashFile(dataFile)))
+            buildHashIndex(allPrimary, primaryHashFile(dataFile));
+        return true;
+    }
+};
+
+// Splits "a|b|c|d" into exactly four fields; false for any other shape
+static bool splitImportLine(string_view line, string_view fields[4]) {
+    for (int i = 0; i < 4; i++) {
+        size_t bar = line.find('|');
+        if ((i < 3) == (bar == string_view::npos)) return false;
+        fields[i] = line.substr(0, bar);
+        if (fields[i].empty()) return false;
+        if (i < 3) line.remove_prefix(bar + 1);
+    }
+    return true;
+}
+
+// The ID must fit the index entries with room for the '*' delete mark
+static bool importIDFits(string_view id, size_t fieldSize) {
+    return id.size() + 2 <= min(fieldSize, sizeof(SecondaryIndex::linkedID));
+}
+
+bool bulkImport(const string &importFile,
+                vector<PrimaryIndex> &doctorPrimary, vector<SecondaryIndex> &doctorSecondary,
+                vector<PrimaryIndex> &apptPrimary, vector<SecondaryIndex> &apptSecondary) {
+    ifstream in(importFile);
+    if (!in.is_open()) {
+        cout << "Could not open " << importFile << " for reading\n";
+        return false;
+    }
+
+    // active IDs, built once; an ID is added as soon as its record is imported
+    unordered_set<string> doctorIDs, appointmentIDs;
+    for (const auto &e : doctorPrimary)
+        if (e.recordID[0] != '*') doctorIDs.insert(e.recordID);
+    for (const auto &e : apptPrimary)
+        if (e.recordID[0] != '*') appointmentIDs.insert(e.recordID);
+
+    ImportFile doctors, appointments;
+    if (!doctors.open(doctorDataFile) || !appointments.open(appointmentDataFile)) {
+        cout << "ERROR - Could not open the data files for writing\n";
+        return false;
+    }
+
+    string line;
+    long long lineNumber = 0, skipped = 0;
+    const long long reportLimit = 20;   // only the first rejected lines are printed
+    while (getline(in, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        string_view fields[4];
+        const char *problem = nullptr;
+        if (!splitImportLine(line, fields) || fields[0].size() != 1) {
+            problem = "expected D|Name|Specialty|ID or A|ID|DoctorID|Date";
+        } else if (fields[0][0] == 'D') {
+            Doctor d(string(fields[1]).c_str(), string(fields[2]).c_str(), string(fields[3]).c_str());
+            if (fields[1].size() >= sizeof(d.Name) || fields[2].size() >= sizeof(d.Specialty) ||
+                fields[1].size() >= sizeof(SecondaryIndex::keyValue) ||
+                !importIDFits(fields[3], sizeof(d.ID))) {
+                problem = "field too long";
+            } else if (!doctorIDs.insert(d.ID).second) {
+                problem = "doctor ID already exists";
+            } else {
+                doctors.add(d.toLine(), d.ID, d.Name);
+            }
+        } else if (fields[0][0] == 'A') {
+            Appointment a(string(fields[1]).c_str(), string(fields[2]).c_str(), string(fields[3]).c_str());
+            if (!importIDFits(fields[1], sizeof(a.ID)) || fields[2].size() >= sizeof(a.DoctorID) ||
+                fields[3].size() >= sizeof(a.Date)) {
+                problem = "field too long";
+            } else if (!doctorIDs.count(a.DoctorID)) {
+                problem = "doctor does not exist";
+            } else if (!appointmentIDs.insert(a.ID).second) {
+                problem = "appointment ID already exists";
+            } else {
+                appointments.add(a.toLine(), a.ID, a.DoctorID);
+            }
+        } else {
+            problem = "unknown record type";
+        }
+
+        if (problem) {
+            if (skipped < reportLimit) cout << "Line " << lineNumber << " skipped: " << problem << "\n";
+            skipped++;
+        }
+    }
+    in.close();
+
+    if (!doctors.finish(doctorPrimary, doctorPrimaryIndexFile, doctorSecondary, doctorSecondaryIndexFile) ||
+        !appointments.finish(apptPrimary, appointmentPrimaryIndexFile, apptSecondary, appointmentSecondaryIndexFile)) {
+        cout << "ERROR - Could not write the data files\n";
+        return false;
+    }
+
+    cout << "Imported " << doctors.primary.size() << " doctor(s) and " << appointments.primary.size()
+         << " appointment(s); " << skipped << " line(s) skipped\n";
     return true;
 }
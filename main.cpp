@@ -1,4 +1,13 @@
 #include "Btree_deletion.cpp"
+#include "Btree_Dump.cpp"
+#include "Btree_OrderStatistics.cpp"
+#include "Btree_Generic.cpp"
+#include "Btree_MultiGet.cpp"
+#include "Btree_Replay.cpp"
+#include "Btree_ReverseScan.cpp"
+#include "Btree_Merge.cpp"
+#include "Btree_LSM.cpp"
+#include "Btree_Learned.cpp"
 #include <limits>
 
 void TestIndexOperations(const char* filename) {
@@ -144,9 +153,21 @@ void manualOperations(const char* filename) {
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
     const char filename[] = "IndexFile.bin";
     int choice;
+
+    // Command line tools run against an existing file instead of the menu
+    if (argc > 1 && string(argv[1]) == "dump") {
+        return RunDumpCommand(argc - 2, argv + 2);
+    }
+    if (argc > 1 && string(argv[1]) == "replay") {
+        return RunReplayCommand(argc - 2, argv + 2);
+    }
+    // --trace FILE records everything the menu does to the index
+    if (argc > 2 && string(argv[1]) == "--trace") {
+        StartTrace(argv[2]);
+    }
     
     // Create initial file
     int numberOfNodes = 10;